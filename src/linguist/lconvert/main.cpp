@@ -225,8 +225,7 @@ int main(int argc, char *argv[])
             return 2;
         }
         tr2.reportDuplicates(tr2.resolveDuplicates(), inFiles[i].name, verbose);
-        for (int j = 0; j < tr2.messageCount(); ++j)
-            tr.replaceSorted(tr2.message(j));
+        tr.replaceSorted(tr2.messages());
     }
 
     if (!targetLanguage.isEmpty())
@@ -0,0 +1,83 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "findindex.h"
+
+#include <algorithm>
+#include <iterator>
+
+QT_BEGIN_NAMESPACE
+
+static inline quint64 trigramAt(const QString &str, qsizetype i)
+{
+    return (quint64(str.at(i).unicode()) << 32) | (quint64(str.at(i + 1).unicode()) << 16)
+            | str.at(i + 2).unicode();
+}
+
+void FindIndex::addTrigrams(int entry, const QString &folded)
+{
+    for (qsizetype i = 0; i + TrigramLength <= folded.size(); ++i) {
+        QList<int> &entries = m_postings[trigramAt(folded, i)];
+        // Entries are mostly added in ascending order, while the index is built
+        if (entries.isEmpty() || entries.last() < entry) {
+            entries.append(entry);
+        } else {
+            auto it = std::lower_bound(entries.begin(), entries.end(), entry);
+            if (*it != entry)
+                entries.insert(it, entry);
+        }
+    }
+}
+
+/*
+ * Adds the trigrams of text to entry. The trigrams of the text without
+ * ampersands are added as well, so that searches which ignore accelerators
+ * are narrowed down correctly, too.
+ */
+void FindIndex::addText(int entry, const QString &text)
+{
+    if (text.size() < TrigramLength)
+        return;
+    QString folded = text.toCaseFolded();
+    addTrigrams(entry, folded);
+    if (folded.contains(QLatin1Char('&'))) {
+        folded.remove(QLatin1Char('&'));
+        addTrigrams(entry, folded);
+    }
+}
+
+/*
+ * Sets entries to the sorted entries that may contain text, whether matching
+ * case or not. Returns false if text is too short to be looked up.
+ */
+bool FindIndex::findCandidates(const QString &text, QList<int> *entries) const
+{
+    if (text.size() < TrigramLength)
+        return false;
+
+    const QString folded = text.toCaseFolded();
+    QList<const QList<int> *> lists;
+    for (qsizetype i = 0; i + TrigramLength <= folded.size(); ++i) {
+        auto it = m_postings.constFind(trigramAt(folded, i));
+        if (it == m_postings.cend()) {
+            entries->clear();
+            return true;
+        }
+        if (!lists.contains(&*it))
+            lists.append(&*it);
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const QList<int> *a, const QList<int> *b) { return a->size() < b->size(); });
+
+    *entries = *lists.first();
+    QList<int> intersection;
+    for (qsizetype i = 1; i < lists.size() && !entries->isEmpty(); ++i) {
+        intersection.clear();
+        std::set_intersection(entries->cbegin(), entries->cend(), lists.at(i)->cbegin(),
+                              lists.at(i)->cend(), std::back_inserter(intersection));
+        entries->swap(intersection);
+    }
+    return true;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,35 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef FINDINDEX_H
+#define FINDINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+QT_BEGIN_NAMESPACE
+
+/*
+ * Maps the trigrams of case folded texts to the entries whose texts contain
+ * them. It narrows a search for a string down to the entries that contain all
+ * of its trigrams, which then have to be searched as before.
+ */
+class FindIndex
+{
+public:
+    enum { TrigramLength = 3 };
+
+    void clear() { m_postings.clear(); }
+    void addText(int entry, const QString &text);
+    bool findCandidates(const QString &text, QList<int> *entries) const;
+
+private:
+    void addTrigrams(int entry, const QString &folded);
+
+    QHash<quint64, QList<int>> m_postings; // sorted entries
+};
+
+QT_END_NAMESPACE
+
+#endif // FINDINDEX_H
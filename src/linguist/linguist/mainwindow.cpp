@@ -26,10 +26,12 @@
 
 #include <QAction>
 #include <QApplication>
+#include <QBitArray>
 #include <QBitmap>
 #include <QCloseEvent>
 #include <QDebug>
 #include <QDockWidget>
+#include <QEventLoop>
 #include <QFile>
 #include <QFileDialog>
 #include <QFileInfo>
@@ -44,6 +46,7 @@
 #include <QMessageBox>
 #include <QMimeData>
 #include <QProcess>
+#include <QProgressDialog>
 #include <QRegularExpression>
 #include <QScreen>
 #include <QShortcut>
@@ -52,6 +55,7 @@
 #include <QStackedWidget>
 #include <QStatusBar>
 #include <QTextStream>
+#include <QTimer>
 #include <QToolBar>
 #include <QUrl>
 #include <QWhatsThis>
@@ -61,6 +65,11 @@
 #include <QPrinter>
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include <ctype.h>
 
 QT_BEGIN_NAMESPACE
@@ -561,40 +570,165 @@ struct OpenedFile {
     bool langGuessed;
 };
 
+struct LoadingFile {
+    QString name;
+    bool readWrite;
+    DataModel *dataModel;
+    QString errorString;
+    QString warning;
+};
+
+// A file that counts the bytes read from it, and fails to read further
+// once loading is canceled.
+class ProgressFile : public QFile
+{
+public:
+    ProgressFile(const QString &name, std::atomic<qint64> *bytesRead,
+                 const std::atomic<bool> *canceled)
+        : QFile(name), m_bytesRead(bytesRead), m_canceled(canceled)
+    {}
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        if (m_canceled->load(std::memory_order_relaxed))
+            return -1;
+        qint64 count = QFile::readData(data, maxSize);
+        if (count > 0)
+            *m_bytesRead += count;
+        return count;
+    }
+
+private:
+    std::atomic<qint64> *m_bytesRead;
+    const std::atomic<bool> *m_canceled;
+};
+
+/*
+ * Reads the files into their data models in worker threads, while the GUI
+ * thread shows the progress. The progress dialog is window-modal, so that the
+ * open files cannot be changed meanwhile. Returns false if the user canceled
+ * the loading.
+ */
+static bool readDataModels(QList<LoadingFile> &files, QWidget *parent)
+{
+    if (files.isEmpty())
+        return true;
+
+    std::atomic<qint64> bytesRead = 0;
+    std::atomic<bool> canceled = false;
+    std::atomic<int> nextFile = 0;
+    std::atomic<int> doneCount = 0;
+    qint64 totalSize = 0;
+    for (const LoadingFile &lf : std::as_const(files))
+        totalSize += QFileInfo(lf.name).size();
+
+    auto work = [&] {
+        for (int i; (i = nextFile++) < files.size();) {
+            LoadingFile &lf = files[i];
+            ProgressFile file(lf.name, &bytesRead, &canceled);
+            if (!file.open(QIODevice::ReadOnly)) {
+                lf.errorString = MainWindow::tr("Cannot open %1: %2")
+                        .arg(lf.name, file.errorString()) + QLatin1Char('\n');
+            } else {
+                lf.dataModel->read(file, lf.name, &lf.errorString, &lf.warning);
+            }
+            ++doneCount;
+        }
+    };
+    const int threadCount = qBound(1, int(std::thread::hardware_concurrency()),
+                                   int(files.size()));
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i)
+        threads.emplace_back(work);
+
+    QProgressDialog progress(MainWindow::tr("Loading..."), MainWindow::tr("&Cancel"), 0, 1000,
+                             parent);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+    QEventLoop loop;
+    QTimer timer;
+    QObject::connect(&timer, &QTimer::timeout, &loop, [&] {
+        if (doneCount == files.size())
+            loop.quit();
+        else if (!canceled && totalSize > 0)
+            progress.setValue(int(qMin(bytesRead * 999 / totalSize, qint64(999))));
+    });
+    QObject::connect(&progress, &QProgressDialog::canceled, &loop, [&] { canceled = true; });
+    timer.start(50);
+    loop.exec();
+
+    for (std::thread &thread : threads)
+        thread.join();
+    return !canceled;
+}
+
 bool MainWindow::openFiles(const QStringList &names, bool globalReadWrite)
 {
     if (names.isEmpty())
         return false;
+    // Requests that do not go through the window, like file open events, can
+    // still arrive while files are loading.
+    if (m_loadingFiles) {
+        QMessageBox::information(this, tr("Qt Linguist"),
+            tr("Cannot open %n file(s) while other files are loading.", nullptr,
+               names.size()));
+        return false;
+    }
 
     bool waitCursor = false;
     statusBar()->showMessage(tr("Loading..."));
     qApp->processEvents();
 
-    QList<OpenedFile> opened;
-    bool closeOld = false;
+    QList<LoadingFile> loading;
     for (QString name : names) {
-        if (!waitCursor) {
-            QApplication::setOverrideCursor(Qt::WaitCursor);
-            waitCursor = true;
-        }
-
         bool readWrite = globalReadWrite;
         if (name.startsWith(QLatin1Char('='))) {
             name.remove(0, 1);
             readWrite = false;
         }
         QFileInfo fi(name);
-        if (fi.exists()) // Make the loader error out instead of reading stdin
+        if (fi.exists())
             name = fi.canonicalFilePath();
-        if (m_dataModel->isFileLoaded(name) >= 0)
+        if (m_dataModel->isFileLoaded(name) >= 0
+            || std::any_of(loading.cbegin(), loading.cend(),
+                           [&name](const LoadingFile &lf) { return lf.name == name; })) {
             continue;
+        }
+        loading.append({ name, readWrite, new DataModel(m_dataModel), QString(), QString() });
+    }
 
-        bool langGuessed;
-        DataModel *dm = new DataModel(m_dataModel);
-        if (!dm->load(name, &langGuessed, this)) {
+    m_loadingFiles = true;
+    const bool loaded = readDataModels(loading, this);
+    m_loadingFiles = false;
+    if (!loaded) {
+        for (const LoadingFile &lf : std::as_const(loading))
+            delete lf.dataModel;
+        statusBar()->clearMessage();
+        return false;
+    }
+
+    QList<OpenedFile> opened;
+    bool closeOld = false;
+    for (int i = 0; i < loading.size(); ++i) {
+        const QString &name = loading.at(i).name;
+        const bool readWrite = loading.at(i).readWrite;
+        DataModel *dm = loading.at(i).dataModel;
+        if (!loading.at(i).errorString.isEmpty()) {
+            QMessageBox::warning(this, QObject::tr("Qt Linguist"), loading.at(i).errorString);
             delete dm;
             continue;
         }
+        if (!loading.at(i).warning.isEmpty())
+            QMessageBox::warning(this, QObject::tr("Qt Linguist"), loading.at(i).warning);
+
+        bool langGuessed;
+        dm->finishLoad(&langGuessed, this);
+
+        if (!waitCursor) {
+            QApplication::setOverrideCursor(Qt::WaitCursor);
+            waitCursor = true;
+        }
         if (opened.isEmpty()) {
             if (!m_dataModel->isWellMergeable(dm)) {
                 QApplication::restoreOverrideCursor();
@@ -606,7 +740,8 @@ bool MainWindow::openFiles(const QStringList &names, bool globalReadWrite)
                     QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel, QMessageBox::Yes))
                 {
                     case QMessageBox::Cancel:
-                        delete dm;
+                        for (int j = i; j < loading.size(); ++j)
+                            delete loading.at(j).dataModel;
                         return false;
                     case QMessageBox::Yes:
                         closeOld = true;
@@ -627,7 +762,8 @@ bool MainWindow::openFiles(const QStringList &names, bool globalReadWrite)
                     QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel, QMessageBox::Yes))
                 {
                     case QMessageBox::Cancel:
-                        delete dm;
+                        for (int j = i; j < loading.size(); ++j)
+                            delete loading.at(j).dataModel;
                         for (const OpenedFile &op : std::as_const(opened))
                             delete op.dataModel;
                         return false;
@@ -969,67 +1105,94 @@ bool MainWindow::searchItem(DataModel::FindLocation where, const QString &search
                             ? Qt::CaseSensitive : Qt::CaseInsensitive) >= 0;
 }
 
+/*
+ * Returns the first model in which the message matches the search, or -1.
+ */
+int MainWindow::findInMessage(const MultiDataIndex &dataIndex)
+{
+    bool hadMessage = false;
+    for (int i = 0; i < m_dataModel->modelCount(); ++i) {
+        if (MessageItem *m = m_dataModel->messageItem(dataIndex, i)) {
+            if (m_findStatusFilter != -1 && m_findStatusFilter != m->type())
+                continue;
+
+            if (m_findOptions.testFlag(FindDialog::SkipObsolete)
+                    && m->isObsolete())
+                continue;
+
+            bool found = true;
+            do {
+                if (!hadMessage) {
+                    if (searchItem(DataModel::SourceText, m->text()))
+                        break;
+                    if (searchItem(DataModel::SourceText, m->pluralText()))
+                        break;
+                    if (searchItem(DataModel::Comments, m->comment()))
+                        break;
+                    if (searchItem(DataModel::Comments, m->extraComment()))
+                        break;
+                }
+                const auto translations = m->translations();
+                for (const QString &trans : translations)
+                    if (searchItem(DataModel::Translations, trans))
+                        return i;
+                if (searchItem(DataModel::Comments, m->translatorComment()))
+                    break;
+                found = false;
+                // did not find the search string in this message
+            } while (0);
+            if (found)
+                return i;
+            hadMessage = true;
+        }
+    }
+    return -1;
+}
+
+void MainWindow::showFoundMessage(const QModelIndex &realIndex, int model,
+                                  const QModelIndex &startIndex)
+{
+    setCurrentMessage(realIndex, model);
+
+    // determine whether the search wrapped
+    const QModelIndex &c1 = m_sortedContextsModel->mapFromSource(
+            m_sortedMessagesModel->mapToSource(startIndex)).parent();
+    const QModelIndex &c2 = m_sortedContextsModel->mapFromSource(realIndex).parent();
+    const QModelIndex &m = m_sortedMessagesModel->mapFromSource(realIndex);
+
+    if (c2.row() < c1.row() || (c1.row() == c2.row() && m.row() <= startIndex.row()))
+        statusBar()->showMessage(tr("Search wrapped."), MessageMS);
+
+    m_findDialog->hide();
+}
+
 void MainWindow::findAgain(FindDirection direction)
 {
     if (m_dataModel->contextCount() == 0)
         return;
 
     const QModelIndex &startIndex = m_messageView->currentIndex();
-    QModelIndex index = (direction == FindNext
-            ? nextMessage(startIndex)
-            : prevMessage(startIndex));
+
+    // The candidates narrow down the messages that need to be searched, but
+    // they are still visited in the order of the views.
+    QBitArray candidates;
+    const bool narrowed = !m_findOptions.testFlag(FindDialog::UseRegExp)
+            && m_dataModel->findCandidates(m_findText, &candidates);
+    QModelIndex index;
+    if (!narrowed || candidates.count(true) > 0) {
+        index = (direction == FindNext
+                ? nextMessage(startIndex)
+                : prevMessage(startIndex));
+    }
 
     while (index.isValid()) {
         QModelIndex realIndex = m_sortedMessagesModel->mapToSource(index);
-        MultiDataIndex dataIndex = m_messageModel->dataIndex(realIndex, -1);
-        bool hadMessage = false;
-        for (int i = 0; i < m_dataModel->modelCount(); ++i) {
-            if (MessageItem *m = m_dataModel->messageItem(dataIndex, i)) {
-                if (m_findStatusFilter != -1 && m_findStatusFilter != m->type())
-                    continue;
-
-                if (m_findOptions.testFlag(FindDialog::SkipObsolete)
-                        && m->isObsolete())
-                    continue;
-
-                bool found = true;
-                do {
-                    if (!hadMessage) {
-                        if (searchItem(DataModel::SourceText, m->text()))
-                            break;
-                        if (searchItem(DataModel::SourceText, m->pluralText()))
-                            break;
-                        if (searchItem(DataModel::Comments, m->comment()))
-                            break;
-                        if (searchItem(DataModel::Comments, m->extraComment()))
-                            break;
-                    }
-                    const auto translations = m->translations();
-                    for (const QString &trans : translations)
-                        if (searchItem(DataModel::Translations, trans))
-                            goto didfind;
-                    if (searchItem(DataModel::Comments, m->translatorComment()))
-                        break;
-                    found = false;
-                    // did not find the search string in this message
-                } while (0);
-                if (found) {
-                  didfind:
-                    setCurrentMessage(realIndex, i);
-
-                    // determine whether the search wrapped
-                    const QModelIndex &c1 = m_sortedContextsModel->mapFromSource(
-                            m_sortedMessagesModel->mapToSource(startIndex)).parent();
-                    const QModelIndex &c2 = m_sortedContextsModel->mapFromSource(realIndex).parent();
-                    const QModelIndex &m = m_sortedMessagesModel->mapFromSource(realIndex);
-
-                    if (c2.row() < c1.row() || (c1.row() == c2.row() && m.row() <= startIndex.row()))
-                        statusBar()->showMessage(tr("Search wrapped."), MessageMS);
-
-                    m_findDialog->hide();
-                    return;
-                }
-                hadMessage = true;
+        const MultiDataIndex dataIndex = m_messageModel->dataIndex(realIndex, -1);
+        if (!narrowed || candidates.testBit(m_dataModel->findEntry(dataIndex))) {
+            const int model = findInMessage(dataIndex);
+            if (model >= 0) {
+                showFoundMessage(realIndex, model, startIndex);
+                return;
             }
         }
 
@@ -1383,7 +1546,7 @@ void MainWindow::setupPhrase()
 
 void MainWindow::closeEvent(QCloseEvent *e)
 {
-    if (maybeSaveAll() && maybeSavePhraseBooks())
+    if (!m_loadingFiles && maybeSaveAll() && maybeSavePhraseBooks())
         e->accept();
     else
         e->ignore();
@@ -1545,8 +1708,8 @@ void MainWindow::translationChanged(const MultiDataIndex &index)
         m_formPreviewView->setSourceContext(index.model(), m);
 }
 
-// This and the following function operate directly on the messageitem,
-// so the model does not emit modification notifications.
+// This and the following function change the messageitem without the model
+// emitting modification notifications.
 void MainWindow::updateTranslation(const QStringList &translations)
 {
     MessageItem *m = m_dataModel->messageItem(m_currentIndex);
@@ -1555,7 +1718,7 @@ void MainWindow::updateTranslation(const QStringList &translations)
     if (translations == m->translations())
         return;
 
-    m->setTranslations(translations);
+    m_dataModel->setTranslations(m_currentIndex, translations);
     if (!m->fileName().isEmpty() && hasFormPreview(m->fileName()))
         m_formPreviewView->setSourceContext(m_currentIndex.model(), m);
     updateDanger(m_currentIndex, true);
@@ -1574,7 +1737,7 @@ void MainWindow::updateTranslatorComment(const QString &comment)
     if (comment == m->translatorComment())
         return;
 
-    m->setTranslatorComment(comment);
+    m_dataModel->setTranslatorComment(m_currentIndex, comment);
 
     m_dataModel->setModified(m_currentIndex.model(), true);
 }
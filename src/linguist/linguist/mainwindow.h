@@ -184,6 +184,8 @@ private:
     void updateDanger(const MultiDataIndex &index, bool verbose);
 
     bool searchItem(DataModel::FindLocation where, const QString &searchWhat);
+    int findInMessage(const MultiDataIndex &dataIndex);
+    void showFoundMessage(const QModelIndex &realIndex, int model, const QModelIndex &startIndex);
 
     QProcess *m_assistantProcess;
     QTreeView *m_contextView;
@@ -226,6 +228,7 @@ private:
     TranslationSettingsDialog *m_translationSettingsDialog;
 
     bool m_settingCurrentMessage;
+    bool m_loadingFiles = false;
     int m_fileActiveModel;
     int m_editActiveModel;
     MultiDataIndex m_currentIndex;
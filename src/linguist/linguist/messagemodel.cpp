@@ -161,20 +161,25 @@ bool DataModel::isWellMergeable(const DataModel *other) const
     return calcMergeScore(this, other) + calcMergeScore(other, this) > 90;
 }
 
-bool DataModel::load(const QString &fileName, bool *langGuessed, QWidget *parent)
+/*
+ * Reads the messages of fileName from dev. This does not interact with the
+ * user, so it can run in a worker thread, as long as nothing else accesses
+ * the model meanwhile. finishLoad() completes the loading in the GUI thread.
+ */
+bool DataModel::read(QIODevice &dev, const QString &fileName, QString *errorString,
+                     QString *warning)
 {
     Translator tor;
     ConversionData cd;
-    bool ok = tor.load(fileName, cd, QLatin1String("auto"));
+    bool ok = tor.load(dev, fileName, cd, QLatin1String("auto"));
     if (!ok) {
-        QMessageBox::warning(parent, QObject::tr("Qt Linguist"), cd.error());
+        *errorString = cd.error();
         return false;
     }
 
     if (!tor.messageCount()) {
-        QMessageBox::warning(parent, QObject::tr("Qt Linguist"),
-                             tr("The translation file '%1' will not be loaded because it is empty.")
-                             .arg(fileName.toHtmlEscaped()));
+        *errorString = tr("The translation file '%1' will not be loaded because it is empty.")
+                .arg(fileName.toHtmlEscaped());
         return false;
     }
 
@@ -201,7 +206,7 @@ bool DataModel::load(const QString &fileName, bool *langGuessed, QWidget *parent
                 err += tr("<br>* Comment: %3").arg(msg.comment().toHtmlEscaped());
         }
       doWarn:
-        QMessageBox::warning(parent, QObject::tr("Qt Linguist"), err);
+        *warning = err;
     }
 
     m_srcFileName = fileName;
@@ -235,10 +240,18 @@ bool DataModel::load(const QString &fileName, bool *langGuessed, QWidget *parent
                 c->incrementNonobsoleteCount();
             }
             c->appendMessage(tmp);
+            countStatistics(&tmp, 1);
             ++m_numMessages;
         }
     }
 
+    m_loadedLanguageCode = tor.languageCode();
+    m_loadedSourceLanguageCode = tor.sourceLanguageCode();
+    return true;
+}
+
+void DataModel::finishLoad(bool *langGuessed, QWidget *parent)
+{
     // Try to detect the correct language in the following order
     // 1. Look for the language attribute in the ts
     //   if that fails
@@ -247,9 +260,9 @@ bool DataModel::load(const QString &fileName, bool *langGuessed, QWidget *parent
     //   if that fails
     // 3. Retrieve the locale from the system.
     *langGuessed = false;
-    QString lang = tor.languageCode();
+    QString lang = m_loadedLanguageCode;
     if (lang.isEmpty()) {
-        lang = QFileInfo(fileName).baseName();
+        lang = QFileInfo(m_srcFileName).baseName();
         int pos = lang.indexOf(QLatin1Char('_'));
         if (pos != -1)
             lang.remove(0, pos + 1);
@@ -275,7 +288,7 @@ bool DataModel::load(const QString &fileName, bool *langGuessed, QWidget *parent
     // 1. Look for the language attribute in the ts
     //   if that fails
     // 2. Assume English
-    lang = tor.sourceLanguageCode();
+    lang = m_loadedSourceLanguageCode;
     if (lang.isEmpty()) {
         l = QLocale::C;
         c = QLocale::AnyTerritory;
@@ -285,8 +298,6 @@ bool DataModel::load(const QString &fileName, bool *langGuessed, QWidget *parent
     setSourceLanguageAndTerritory(l, c);
 
     setModified(false);
-
-    return true;
 }
 
 bool DataModel::save(const QString &fileName, QWidget *parent)
@@ -412,35 +423,53 @@ void DataModel::setSourceLanguageAndTerritory(QLocale::Language lang, QLocale::T
     setModified(true);
 }
 
+/*
+ * The statistics are kept up to date by removing each message from them
+ * before it is changed and adding it back afterwards, so that they are not
+ * recounted from all messages whenever they are shown.
+ */
+void DataModel::countStatistics(const MessageItem *m, int sign)
+{
+    if (m->isObsolete()) {
+        m_numObsolete += sign;
+        return;
+    }
+    const bool finished = m->isFinished();
+    if (!finished && !m->isUnfinished())
+        return;
+
+    int words = 0, chars = 0, charsSpc = 0;
+    const QStringList translations = m->translations();
+    for (const QString &trnsl : translations)
+        doCharCounting(trnsl, words, chars, charsSpc);
+    const bool hasDanger = m->danger() && !translations.isEmpty();
+    if (finished) {
+        m_trWordsFinished += sign * words;
+        m_trCharsFinished += sign * chars;
+        m_trCharsSpcFinished += sign * charsSpc;
+        (hasDanger ? m_numFinishedDanger : m_numFinishedNoDanger) += sign;
+    } else {
+        m_trWordsUnfinished += sign * words;
+        m_trCharsUnfinished += sign * chars;
+        m_trCharsSpcUnfinished += sign * charsSpc;
+        (hasDanger ? m_numUnfinishedDanger : m_numUnfinishedNoDanger) += sign;
+    }
+}
+
 void DataModel::updateStatistics()
 {
     StatisticalData stats {};
-    for (DataModelIterator it(this); it.isValid(); ++it) {
-        const MessageItem *mi = it.current();
-        if (mi->isObsolete()) {
-            stats.obsoleteMsg++;
-        } else if (mi->isFinished()) {
-            bool hasDanger = false;
-            for (const QString &trnsl : mi->translations()) {
-                doCharCounting(trnsl, stats.wordsFinished, stats.charsFinished, stats.charsSpacesFinished);
-                hasDanger |= mi->danger();
-            }
-            if (hasDanger)
-                stats.translatedMsgDanger++;
-            else
-                stats.translatedMsgNoDanger++;
-        } else if (mi->isUnfinished()) {
-            bool hasDanger = false;
-            for (const QString &trnsl : mi->translations()) {
-                doCharCounting(trnsl, stats.wordsUnfinished, stats.charsUnfinished, stats.charsSpacesUnfinished);
-                hasDanger |= mi->danger();
-            }
-            if (hasDanger)
-                stats.unfinishedMsgDanger++;
-            else
-                stats.unfinishedMsgNoDanger++;
-        }
-    }
+    stats.wordsFinished = m_trWordsFinished;
+    stats.charsFinished = m_trCharsFinished;
+    stats.charsSpacesFinished = m_trCharsSpcFinished;
+    stats.wordsUnfinished = m_trWordsUnfinished;
+    stats.charsUnfinished = m_trCharsUnfinished;
+    stats.charsSpacesUnfinished = m_trCharsSpcUnfinished;
+    stats.translatedMsgNoDanger = m_numFinishedNoDanger;
+    stats.translatedMsgDanger = m_numFinishedDanger;
+    stats.unfinishedMsgNoDanger = m_numUnfinishedNoDanger;
+    stats.unfinishedMsgDanger = m_numUnfinishedDanger;
+    stats.obsoleteMsg = m_numObsolete;
     stats.wordsSource = m_srcWords;
     stats.charsSource = m_srcChars;
     stats.charsSpacesSource = m_srcCharsSpc;
@@ -539,6 +568,7 @@ MultiContextItem::MultiContextItem(int oldCount, ContextItem *ctx, bool writable
         mList.append(m);
         eList.append(0);
         m_multiMessageList.append(MultiMessageItem(m));
+        addMessageIndex(j);
     }
     for (int i = 0; i < oldCount; ++i) {
         m_messageLists.append(eList);
@@ -596,10 +626,14 @@ void MultiContextItem::appendMessageItems(const QList<MessageItem *> &m)
     for (int i = 0; i < m_messageLists.size() - 1; ++i)
         m_messageLists[i] += nullItems;
     m_messageLists.last() += m;
-    for (MessageItem *mi : m)
+    for (MessageItem *mi : m) {
         m_multiMessageList.append(MultiMessageItem(mi));
+        addMessageIndex(m_multiMessageList.size() - 1);
+    }
 }
 
+// Leaves the message indexes stale, so that removing several items does not
+// renumber them each time. Call rebuildMessageIndexes() afterwards.
 void MultiContextItem::removeMultiMessageItem(int pos)
 {
     for (int i = 0; i < m_messageLists.size(); ++i)
@@ -607,6 +641,24 @@ void MultiContextItem::removeMultiMessageItem(int pos)
     m_multiMessageList.removeAt(pos);
 }
 
+void MultiContextItem::rebuildMessageIndexes()
+{
+    m_messageIdx.clear();
+    m_messageIdIdx.clear();
+    for (int i = 0; i < m_multiMessageList.size(); ++i)
+        addMessageIndex(i);
+}
+
+void MultiContextItem::addMessageIndex(int pos)
+{
+    const MultiMessageItem &mm = m_multiMessageList.at(pos);
+    const std::pair<QString, QString> key(mm.text(), mm.comment());
+    if (!m_messageIdx.contains(key))
+        m_messageIdx.insert(key, pos);
+    if (!mm.id().isEmpty() && !m_messageIdIdx.contains(mm.id()))
+        m_messageIdIdx.insert(mm.id(), pos);
+}
+
 int MultiContextItem::firstNonobsoleteMessageIndex(int msgIdx) const
 {
     for (int i = 0; i < m_messageLists.size(); ++i)
@@ -617,22 +669,12 @@ int MultiContextItem::firstNonobsoleteMessageIndex(int msgIdx) const
 
 int MultiContextItem::findMessage(const QString &sourcetext, const QString &comment) const
 {
-    for (int i = 0, cnt = messageCount(); i < cnt; ++i) {
-        MultiMessageItem *m = multiMessageItem(i);
-        if (m->text() == sourcetext && m->comment() == comment)
-            return i;
-    }
-    return -1;
+    return m_messageIdx.value(std::pair<QString, QString>(sourcetext, comment), -1);
 }
 
 int MultiContextItem::findMessageById(const QString &id) const
 {
-    for (int i = 0, cnt = messageCount(); i < cnt; ++i) {
-        MultiMessageItem *m = multiMessageItem(i);
-        if (m->id() == id)
-            return i;
-    }
-    return -1;
+    return m_messageIdIdx.value(id, -1);
 }
 
 /******************************************************************************
@@ -760,6 +802,7 @@ void MultiDataModel::append(DataModel *dm, bool readWrite)
                 m_numMessages += appendItems.size();
             }
         } else {
+            m_contextIdx.insert(c->context(), contextCount());
             m_multiContextList << MultiContextItem(modelCount() - 1, c, readWrite);
             m_numMessages += c->messageCount();
             ++appendedContexts;
@@ -774,6 +817,7 @@ void MultiDataModel::append(DataModel *dm, bool readWrite)
     }
     dm->setWritable(readWrite);
     updateCountsOnAdd(modelCount() - 1, readWrite);
+    invalidateFindIndex();
     connect(dm, &DataModel::modifiedChanged,
             this, &MultiDataModel::onModifiedChanged);
     connect(dm, &DataModel::languageChanged,
@@ -789,6 +833,7 @@ void MultiDataModel::close(int model)
         closeAll();
     } else {
         updateCountsOnRemove(model, isModelWritable(model));
+        invalidateFindIndex();
         int delCol = model + 1;
         m_msgModel->beginRemoveColumns(QModelIndex(), delCol, delCol);
         for (int i = m_multiContextList.size(); --i >= 0;) {
@@ -802,19 +847,30 @@ void MultiDataModel::close(int model)
         for (int i = m_multiContextList.size(); --i >= 0;) {
             MultiContextItem &mc = m_multiContextList[i];
             QModelIndex contextIdx = m_msgModel->createIndex(i, 0);
+            bool removedMessages = false;
             for (int j = mc.messageCount(); --j >= 0;)
                 if (mc.multiMessageItem(j)->isEmpty()) {
                     m_msgModel->beginRemoveRows(contextIdx, j, j);
                     mc.removeMultiMessageItem(j);
                     m_msgModel->endRemoveRows();
                     --m_numMessages;
+                    removedMessages = true;
                 }
             if (!mc.messageCount()) {
                 m_msgModel->beginRemoveRows(QModelIndex(), i, i);
                 m_multiContextList.removeAt(i);
                 m_msgModel->endRemoveRows();
+            } else if (removedMessages) {
+                mc.rebuildMessageIndexes();
             }
         }
+        // Rebuild the context index once instead of renumbering it per removed context
+        m_contextIdx.clear();
+        for (int i = 0; i < m_multiContextList.size(); ++i) {
+            const QString &context = m_multiContextList.at(i).context();
+            if (!m_contextIdx.contains(context))
+                m_contextIdx.insert(context, i);
+        }
         onModifiedChanged();
     }
 }
@@ -828,6 +884,8 @@ void MultiDataModel::closeAll()
     qDeleteAll(m_dataModels);
     m_dataModels.clear();
     m_multiContextList.clear();
+    m_contextIdx.clear();
+    invalidateFindIndex();
     m_msgModel->endResetModel();
     emit allModelsDeleted();
     onModifiedChanged();
@@ -957,22 +1015,88 @@ int MultiDataModel::isFileLoaded(const QString &name) const
 
 int MultiDataModel::findContextIndex(const QString &context) const
 {
-    for (int i = 0; i < m_multiContextList.size(); ++i) {
-        const MultiContextItem &mc = m_multiContextList[i];
-        if (mc.context() == context)
-            return i;
-    }
-    return -1;
+    return m_contextIdx.value(context, -1);
 }
 
 MultiContextItem *MultiDataModel::findContext(const QString &context) const
 {
+    int idx = findContextIndex(context);
+    return idx >= 0 ? multiContextItem(idx) : 0;
+}
+
+void MultiDataModel::invalidateFindIndex()
+{
+    m_findIndexOk = false;
+    m_findIndex.clear();
+    m_findContextOffsets.clear();
+    m_findEntryCount = 0;
+}
+
+void MultiDataModel::addToFindIndex(const MultiDataIndex &index, const MessageItem *m) const
+{
+    const int entry = findEntry(index);
+    m_findIndex.addText(entry, m->text());
+    m_findIndex.addText(entry, m->pluralText());
+    m_findIndex.addText(entry, m->comment());
+    m_findIndex.addText(entry, m->extraComment());
+    m_findIndex.addText(entry, m->translatorComment());
+    for (const QString &translation : m->translations())
+        m_findIndex.addText(entry, translation);
+}
+
+void MultiDataModel::ensureFindIndexed() const
+{
+    if (m_findIndexOk)
+        return;
+    m_findIndexOk = true;
+
+    int offset = 0;
+    for (const MultiContextItem &mc : m_multiContextList) {
+        m_findContextOffsets.append(offset);
+        offset += mc.messageCount();
+    }
+    m_findEntryCount = offset;
     for (int i = 0; i < m_multiContextList.size(); ++i) {
-        const MultiContextItem &mc = m_multiContextList[i];
-        if (mc.context() == context)
-            return const_cast<MultiContextItem *>(&mc);
+        const MultiContextItem &mc = m_multiContextList.at(i);
+        for (int j = 0; j < mc.messageCount(); ++j) {
+            for (int model = 0; model < modelCount(); ++model) {
+                if (const MessageItem *m = mc.messageItem(model, j))
+                    addToFindIndex(MultiDataIndex(model, i, j), m);
+            }
+        }
     }
-    return 0;
+}
+
+/*
+ * Sets the bits of candidates for the messages that may contain text in any
+ * of the fields that can be searched. The bits are numbered like the entries
+ * returned by findEntry(). Returns false if the text is too short to narrow
+ * down the messages, so that all of them have to be searched.
+ *
+ * Edited texts are added to the index, but the texts they replace are not
+ * removed, so there may be more candidates than necessary.
+ */
+bool MultiDataModel::findCandidates(const QString &text, QBitArray *candidates) const
+{
+    if (text.size() < FindIndex::TrigramLength)
+        return false;
+    ensureFindIndexed();
+
+    QList<int> entries;
+    if (!m_findIndex.findCandidates(text, &entries))
+        return false;
+    candidates->fill(false, m_findEntryCount);
+    for (int entry : std::as_const(entries))
+        candidates->setBit(entry);
+    return true;
+}
+
+/*
+ * Returns the number of the multi-message in the bits set by findCandidates().
+ */
+int MultiDataModel::findEntry(const MultiDataIndex &index) const
+{
+    return m_findContextOffsets.at(index.context()) + index.message();
 }
 
 MessageItem *MultiDataModel::messageItem(const MultiDataIndex &index, int model) const
@@ -992,11 +1116,35 @@ void MultiDataModel::setTranslation(const MultiDataIndex &index, const QString &
     MessageItem *m = messageItem(index);
     if (translation == m->translation())
         return;
+    DataModel *dm = m_dataModels[index.model()];
+    dm->countStatistics(m, -1);
     m->setTranslation(translation);
+    dm->countStatistics(m, 1);
+    if (m_findIndexOk)
+        addToFindIndex(index, m);
     setModified(index.model(), true);
     emit translationChanged(index);
 }
 
+void MultiDataModel::setTranslations(const MultiDataIndex &index, const QStringList &translations)
+{
+    MessageItem *m = messageItem(index);
+    DataModel *dm = m_dataModels[index.model()];
+    dm->countStatistics(m, -1);
+    m->setTranslations(translations);
+    dm->countStatistics(m, 1);
+    if (m_findIndexOk)
+        addToFindIndex(index, m);
+}
+
+void MultiDataModel::setTranslatorComment(const MultiDataIndex &index, const QString &comment)
+{
+    MessageItem *m = messageItem(index);
+    m->setTranslatorComment(comment);
+    if (m_findIndexOk)
+        addToFindIndex(index, m);
+}
+
 void MultiDataModel::setFinished(const MultiDataIndex &index, bool finished)
 {
     MultiContextItem *mc = multiContextItem(index.context());
@@ -1004,8 +1152,11 @@ void MultiDataModel::setFinished(const MultiDataIndex &index, bool finished)
     ContextItem *c = contextItem(index);
     MessageItem *m = messageItem(index);
     TranslatorMessage::Type type = m->type();
+    DataModel *dm = m_dataModels[index.model()];
     if (type == TranslatorMessage::Unfinished && finished) {
+        dm->countStatistics(m, -1);
         m->setType(TranslatorMessage::Finished);
+        dm->countStatistics(m, 1);
         mm->decrementUnfinishedCount();
         if (!mm->countUnfinished()) {
             incrementFinishedCount();
@@ -1025,7 +1176,9 @@ void MultiDataModel::setFinished(const MultiDataIndex &index, bool finished)
         emit messageDataChanged(index);
         setModified(index.model(), true);
     } else if (type == TranslatorMessage::Finished && !finished) {
+        dm->countStatistics(m, -1);
         m->setType(TranslatorMessage::Unfinished);
+        dm->countStatistics(m, 1);
         mm->incrementUnfinishedCount();
         if (mm->countUnfinished() == 1) {
             decrementFinishedCount();
@@ -1051,6 +1204,7 @@ void MultiDataModel::setDanger(const MultiDataIndex &index, bool danger)
 {
     ContextItem *c = contextItem(index);
     MessageItem *m = messageItem(index);
+    DataModel *dm = m_dataModels[index.model()];
     if (!m->danger() && danger) {
         if (m->isFinished()) {
             c->incrementFinishedDangerCount();
@@ -1062,7 +1216,9 @@ void MultiDataModel::setDanger(const MultiDataIndex &index, bool danger)
                 emit contextDataChanged(index);
         }
         emit messageDataChanged(index);
+        dm->countStatistics(m, -1);
         m->setDanger(danger);
+        dm->countStatistics(m, 1);
     } else if (m->danger() && !danger) {
         if (m->isFinished()) {
             c->decrementFinishedDangerCount();
@@ -1074,7 +1230,9 @@ void MultiDataModel::setDanger(const MultiDataIndex &index, bool danger)
                 emit contextDataChanged(index);
         }
         emit messageDataChanged(index);
+        dm->countStatistics(m, -1);
         m->setDanger(danger);
+        dm->countStatistics(m, 1);
     }
 }
 
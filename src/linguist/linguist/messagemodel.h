@@ -4,9 +4,11 @@
 #ifndef MESSAGEMODEL_H
 #define MESSAGEMODEL_H
 
+#include "findindex.h"
 #include "translator.h"
 
 #include <QtCore/QAbstractItemModel>
+#include <QtCore/QBitArray>
 #include <QtCore/QList>
 #include <QtCore/QHash>
 #include <QtCore/QLocale>
@@ -163,7 +165,8 @@ public:
     void setWritable(bool writable) { m_writable = writable; }
 
     bool isWellMergeable(const DataModel *other) const;
-    bool load(const QString &fileName, bool *langGuessed, QWidget *parent);
+    bool read(QIODevice &dev, const QString &fileName, QString *errorString, QString *warning);
+    void finishLoad(bool *langGuessed, QWidget *parent);
     bool save(QWidget *parent) { return save(m_srcFileName, parent); }
     bool saveAs(const QString &newFileName, QWidget *parent);
     bool release(const QString &fileName, bool verbose,
@@ -186,7 +189,7 @@ public:
     const QList<bool> &countRefNeeds() const { return m_countRefNeeds; }
 
     QStringList normalizedTranslations(const MessageItem &m) const;
-    void doCharCounting(const QString& text, int& trW, int& trC, int& trCS);
+    static void doCharCounting(const QString& text, int& trW, int& trC, int& trCS);
     void updateStatistics();
 
     int getSrcWords() const { return m_srcWords; }
@@ -201,10 +204,13 @@ signals:
 
 private:
     friend class DataModelIterator;
+    friend class MultiDataModel;
     QList<ContextItem> m_contextList;
 
     bool save(const QString &fileName, QWidget *parent);
     void updateLocale();
+    // Adds (sign 1) or removes (sign -1) the message to/from the statistics
+    void countStatistics(const MessageItem *m, int sign);
 
     bool m_writable;
     bool m_modified;
@@ -215,6 +221,17 @@ private:
     int m_srcWords;
     int m_srcChars;
     int m_srcCharsSpc;
+    int m_trWordsFinished = 0;
+    int m_trCharsFinished = 0;
+    int m_trCharsSpcFinished = 0;
+    int m_trWordsUnfinished = 0;
+    int m_trCharsUnfinished = 0;
+    int m_trCharsSpcUnfinished = 0;
+    int m_numFinishedNoDanger = 0;
+    int m_numFinishedDanger = 0;
+    int m_numUnfinishedNoDanger = 0;
+    int m_numUnfinishedDanger = 0;
+    int m_numObsolete = 0;
 
     QString m_srcFileName;
     QLocale::Language m_language;
@@ -223,6 +240,9 @@ private:
     QLocale::Territory m_sourceTerritory;
     bool m_relativeLocations;
     Translator::ExtraData m_extra;
+    // As read from the file, for finishLoad()
+    QString m_loadedLanguageCode;
+    QString m_loadedSourceLanguageCode;
 
     QString m_localizedLanguage;
     QStringList m_numerusForms;
@@ -300,6 +320,8 @@ private:
     void putMessageItem(int pos, MessageItem *m);
     void appendMessageItems(const QList<MessageItem *> &m);
     void removeMultiMessageItem(int pos);
+    void rebuildMessageIndexes();
+    void addMessageIndex(int pos);
     void incrementFinishedCount() { ++m_finishedCount; }
     void decrementFinishedCount() { --m_finishedCount; }
     void incrementEditableCount() { ++m_editableCount; }
@@ -314,6 +336,10 @@ private:
     // The next two could be in the MultiMessageItems, but are here for efficiency
     QList<QList<MessageItem *> > m_messageLists;
     QList<QList<MessageItem *> *> m_writableMessageLists;
+    // The position of the first multi-message with each (source text, comment)
+    // pair and with each id, for merging models in linear time
+    QHash<std::pair<QString, QString>, int> m_messageIdx;
+    QHash<QString, int> m_messageIdIdx;
     int m_finishedCount; // read-write
     int m_editableCount; // read-write
     int m_nonobsoleteCount; // all (note: this counts messages, not multi-messages)
@@ -397,6 +423,9 @@ public:
 
     // Per message
     void setTranslation(const MultiDataIndex &index, const QString &translation);
+    // Unlike setTranslation(), these do not emit any signals
+    void setTranslations(const MultiDataIndex &index, const QStringList &translations);
+    void setTranslatorComment(const MultiDataIndex &index, const QString &comment);
     void setFinished(const MultiDataIndex &index, bool finished);
     void setDanger(const MultiDataIndex &index, bool danger);
 
@@ -410,6 +439,8 @@ public:
     MessageItem *messageItem(const MultiDataIndex &index) const { return messageItem(index, index.model()); }
     int findContextIndex(const QString &context) const;
     MultiContextItem *findContext(const QString &context) const;
+    bool findCandidates(const QString &text, QBitArray *candidates) const;
+    int findEntry(const MultiDataIndex &index) const;
 
     static QString condenseFileNames(const QStringList &names);
     static QStringList prettifyFileNames(const QStringList &names);
@@ -445,6 +476,9 @@ private:
     void decrementFinishedCount() { --m_numFinished; }
     void incrementEditableCount() { ++m_numEditable; }
     void decrementEditableCount() { --m_numEditable; }
+    void invalidateFindIndex();
+    void ensureFindIndexed() const;
+    void addToFindIndex(const MultiDataIndex &index, const MessageItem *m) const;
 
     int m_numFinished;
     int m_numEditable;
@@ -453,6 +487,13 @@ private:
     bool m_modified;
 
     QList<MultiContextItem> m_multiContextList;
+    QHash<QString, int> m_contextIdx; // position of the first context with each name
+    // The texts of the messages in all models, for finding them. Each
+    // multi-message is an entry, numbered in the order of the contexts.
+    mutable bool m_findIndexOk = false;
+    mutable FindIndex m_findIndex;
+    mutable QList<int> m_findContextOffsets; // the first entry of each context
+    mutable int m_findEntryCount = 0;
     QList<DataModel *> m_dataModels;
 
     MessageModel *m_msgModel;
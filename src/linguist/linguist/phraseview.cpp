@@ -20,6 +20,29 @@
 
 QT_BEGIN_NAMESPACE
 
+/*
+ * The source texts of all messages of one model. The similarity index is
+ * built by the worker thread once it is first searched, and only the worker
+ * thread accesses it. Whether a message is a suitable guess changes as it
+ * is translated, so that is decided for each request instead.
+ */
+struct GuessIndex
+{
+    // Closing a model removes messages and contexts one by one, so an index
+    // may have been built in between. Such an index is recognized by these.
+    int contextCount;
+    int messageCount;
+    QList<MultiDataIndex> messages;
+    QStringList sources; // until the index is built
+    StringSimilarityIndex index;
+    bool built = false;
+};
+
+static bool isGuess(const MessageItem *m)
+{
+    return m && m->type() != TranslatorMessage::Unfinished && !m->translation().isEmpty();
+}
+
 static QString phraseViewHeaderKey()
 {
     return settingPath("PhraseViewHeader");
@@ -56,10 +79,26 @@ PhraseView::PhraseView(MultiDataModel *model, QList<QHash<QString, QList<Phrase
 
     connect(this, &QAbstractItemView::activated,
             this, &PhraseView::selectPhrase);
+
+    // Appending and closing models moves the messages of all models
+    connect(m_dataModel, &MultiDataModel::modelAppended,
+            this, &PhraseView::invalidateGuessIndexes);
+    connect(m_dataModel, &MultiDataModel::modelDeleted,
+            this, &PhraseView::invalidateGuessIndexes);
+    connect(m_dataModel, &MultiDataModel::allModelsDeleted,
+            this, &PhraseView::invalidateGuessIndexes);
 }
 
 PhraseView::~PhraseView()
 {
+    if (m_guessThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> locker(m_guessMutex);
+            m_stopGuessing = true;
+        }
+        m_guessCondition.notify_one();
+        m_guessThread.join();
+    }
     QSettings().setValue(phraseViewHeaderKey(), header()->saveState());
     deleteGuesses();
 }
@@ -172,60 +211,13 @@ void PhraseView::resetNumGuesses()
     setSourceText(m_modelIndex, m_sourceText);
 }
 
-static CandidateList similarTextHeuristicCandidates(MultiDataModel *model, int mi,
-    const char *text, int maxCandidates)
-{
-    QList<int> scores;
-    CandidateList candidates;
-
-    StringSimilarityMatcher stringmatcher(QString::fromLatin1(text));
-
-    for (MultiDataModelIterator it(model, mi); it.isValid(); ++it) {
-        MessageItem *m = it.current();
-        if (!m)
-            continue;
-
-        TranslatorMessage mtm = m->message();
-        if (mtm.type() == TranslatorMessage::Unfinished
-            || mtm.translation().isEmpty())
-            continue;
-
-        QString s = m->text();
-
-        int score = stringmatcher.getSimilarityScore(s);
-
-        if (candidates.size() == maxCandidates && score > scores[maxCandidates - 1])
-            candidates.removeLast();
-        if (candidates.size() < maxCandidates && score >= textSimilarityThreshold ) {
-            Candidate cand(mtm.context(), s, mtm.comment(), mtm.translation());
-
-            int i;
-            for (i = 0; i < candidates.size(); ++i) {
-                if (score >= scores.at(i)) {
-                    if (score == scores.at(i)) {
-                        if (candidates.at(i) == cand)
-                            goto continue_outer_loop;
-                    } else {
-                        break;
-                    }
-                }
-            }
-            scores.insert(i, score);
-            candidates.insert(i, cand);
-        }
-        continue_outer_loop:
-        ;
-    }
-    return candidates;
-}
-
-
 void PhraseView::setSourceText(int model, const QString &sourceText)
 {
     m_modelIndex = model;
     m_sourceText = sourceText;
     m_phraseModel->removePhrases();
     deleteGuesses();
+    ++m_guessGeneration;
 
     if (model < 0)
         return;
@@ -234,23 +226,110 @@ void PhraseView::setSourceText(int model, const QString &sourceText)
     for (Phrase *p : phrases)
         m_phraseModel->addPhrase(p);
 
-    if (!sourceText.isEmpty() && m_doGuesses) {
-        const CandidateList cl = similarTextHeuristicCandidates(m_dataModel, model,
-            sourceText.toLatin1(), m_maxCandidates);
-        int n = 0;
-        for (const Candidate &candidate : cl) {
-            QString def;
-            if (n < 9)
-                def = tr("Guess from '%1' (%2)")
-                      .arg(candidate.context, QKeySequence(Qt::CTRL | (Qt::Key_0 + (n + 1)))
-                                              .toString(QKeySequence::NativeText));
-            else
-                def = tr("Guess from '%1'").arg(candidate.context);
-            Phrase *guess = new Phrase(candidate.source, candidate.translation, def, candidate, n);
-            m_guesses.append(guess);
-            m_phraseModel->addPhrase(guess);
-            ++n;
+    if (!sourceText.isEmpty() && m_doGuesses)
+        requestGuesses(model, sourceText);
+}
+
+void PhraseView::invalidateGuessIndexes()
+{
+    m_guessIndexes.clear();
+    m_guessIndex.reset();
+    ++m_guessGeneration;
+}
+
+void PhraseView::requestGuesses(int model, const QString &sourceText)
+{
+    if (m_guessIndexes.size() != m_dataModel->modelCount())
+        m_guessIndexes.resize(m_dataModel->modelCount());
+    std::shared_ptr<GuessIndex> &index = m_guessIndexes[model];
+    if (!index || index->contextCount != m_dataModel->contextCount()
+        || index->messageCount != m_dataModel->messageCount()) {
+        index = std::make_shared<GuessIndex>();
+        index->contextCount = m_dataModel->contextCount();
+        index->messageCount = m_dataModel->messageCount();
+        for (MultiDataModelIterator it(m_dataModel, model); it.isValid(); ++it) {
+            if (const MessageItem *m = it.current()) {
+                index->messages.append(it);
+                index->sources.append(m->text());
+            }
+        }
+    }
+    m_guessIndex = index;
+
+    GuessRequest request;
+    request.index = index;
+    request.text = QString::fromLatin1(sourceText.toLatin1());
+    request.maxCandidates = m_maxCandidates;
+    request.eligible.resize(index->messages.size());
+    for (int i = 0; i < index->messages.size(); ++i) {
+        if (isGuess(m_dataModel->messageItem(index->messages.at(i))))
+            request.eligible.setBit(i);
+    }
+    request.generation = m_guessGeneration;
+
+    {
+        std::lock_guard<std::mutex> locker(m_guessMutex);
+        m_guessRequest = std::move(request);
+    }
+    m_guessCondition.notify_one();
+    if (!m_guessThread.joinable())
+        m_guessThread = std::thread(&PhraseView::findGuesses, this);
+}
+
+// Runs in the worker thread
+void PhraseView::findGuesses()
+{
+    for (;;) {
+        GuessRequest request;
+        {
+            std::unique_lock<std::mutex> locker(m_guessMutex);
+            m_guessCondition.wait(locker, [this] { return m_stopGuessing || m_guessRequest; });
+            if (m_stopGuessing)
+                return;
+            request = std::move(*m_guessRequest);
+            m_guessRequest.reset();
+        }
+
+        GuessIndex &index = *request.index;
+        if (!index.built) {
+            index.index.reserve(index.sources.size());
+            for (const QString &source : std::as_const(index.sources))
+                index.index.append(source);
+            index.sources.clear();
+            index.built = true;
         }
+        const QList<int> positions = index.index.bestMatches(request.text, request.maxCandidates,
+                                                             nullptr, &request.eligible);
+        QMetaObject::invokeMethod(this, [this, generation = request.generation, positions] {
+            showGuesses(generation, positions);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void PhraseView::showGuesses(quint64 generation, const QList<int> &positions)
+{
+    if (generation != m_guessGeneration || m_guessIndex->contextCount != m_dataModel->contextCount()
+        || m_guessIndex->messageCount != m_dataModel->messageCount()) {
+        return;
+    }
+
+    int n = 0;
+    for (int pos : positions) {
+        const MessageItem *m = m_dataModel->messageItem(m_guessIndex->messages.at(pos));
+        if (!isGuess(m))
+            continue;
+        const Candidate candidate(m->context(), m->text(), m->comment(), m->translation());
+        QString def;
+        if (n < 9)
+            def = tr("Guess from '%1' (%2)")
+                  .arg(candidate.context, QKeySequence(Qt::CTRL | (Qt::Key_0 + (n + 1)))
+                                          .toString(QKeySequence::NativeText));
+        else
+            def = tr("Guess from '%1'").arg(candidate.context);
+        Phrase *guess = new Phrase(candidate.source, candidate.translation, def, candidate, n);
+        m_guesses.append(guess);
+        m_phraseModel->addPhrase(guess);
+        ++n;
     }
 }
 
@@ -4,16 +4,24 @@
 #ifndef PHRASEVIEW_H
 #define PHRASEVIEW_H
 
+#include <QBitArray>
 #include <QList>
 #include <QTreeView>
 #include "phrase.h"
 
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
 QT_BEGIN_NAMESPACE
 
 static const int DefaultMaxCandidates = 5;
 
 class MultiDataModel;
 class PhraseModel;
+struct GuessIndex;
 
 class PhraseView : public QTreeView
 {
@@ -55,6 +63,10 @@ private slots:
 private:
     QList<Phrase *> getPhrases(int model, const QString &sourceText);
     void deleteGuesses();
+    void invalidateGuessIndexes();
+    void requestGuesses(int model, const QString &sourceText);
+    void findGuesses();
+    void showGuesses(quint64 generation, const QList<int> &positions);
 
     MultiDataModel *m_dataModel;
     QList<QHash<QString, QList<Phrase *> > > *m_phraseDict;
@@ -64,6 +76,25 @@ private:
     int m_modelIndex;
     bool m_doGuesses;
     int m_maxCandidates = DefaultMaxCandidates;
+
+    // Guesses are searched for in a worker thread. Each request has a new
+    // generation, so that results for an outdated request are dropped.
+    QList<std::shared_ptr<GuessIndex>> m_guessIndexes; // per model, built on demand
+    std::shared_ptr<GuessIndex> m_guessIndex; // of the current request
+    quint64 m_guessGeneration = 0;
+    std::thread m_guessThread;
+    std::mutex m_guessMutex;
+    std::condition_variable m_guessCondition;
+    struct GuessRequest
+    {
+        std::shared_ptr<GuessIndex> index;
+        QString text;
+        int maxCandidates;
+        QBitArray eligible;
+        quint64 generation;
+    };
+    std::optional<GuessRequest> m_guessRequest; // the latest one
+    bool m_stopGuessing = false;
 };
 
 QT_END_NAMESPACE
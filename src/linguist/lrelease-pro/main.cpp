@@ -81,6 +81,9 @@ int main(int argc, char **argv)
         } else if (!strcmp(argv[i], "-help")) {
             printUsage();
             return 0;
+        } else if (!strcmp(argv[i], "-j") && i < argc - 1) {
+            lreleaseOptions << QString::fromLocal8Bit(argv[i]);
+            lreleaseOptions << QString::fromLocal8Bit(argv[++i]);
         } else if (strlen(argv[i]) > 0 && argv[i][0] == '-') {
             lreleaseOptions << QString::fromLocal8Bit(argv[i]);
         } else {
@@ -108,10 +111,16 @@ int main(int argc, char **argv)
         return 1;
     }
 
+    // lrelease evaluates the projects itself, unless the project description
+    // is to be kept.
+    if (!keepProjectDescription) {
+        runQtTool(QStringLiteral("lrelease"), app.arguments().mid(1));
+        return 0;
+    }
+
     lprodumpOptions << proFiles;
     std::unique_ptr<QTemporaryFile> projectDescription = createProjectDescription(lprodumpOptions);
-    if (keepProjectDescription)
-        projectDescription->setAutoRemove(false);
+    projectDescription->setAutoRemove(false);
     lreleaseOptions << QStringLiteral("-project") << projectDescription->fileName();
 
     runQtTool(QStringLiteral("lrelease"), lreleaseOptions);
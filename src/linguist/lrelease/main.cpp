@@ -5,7 +5,7 @@
 
 #include <profileutils.h>
 #include <projectdescriptionreader.h>
-#include <runqttool.h>
+#include <projectdumper.h>
 
 #ifndef QT_BOOTSTRAPPED
 #include <QtCore/QCoreApplication>
@@ -20,18 +20,38 @@
 #include <QtCore/QTextStream>
 #include <QtCore/QLibraryInfo>
 
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
 QT_USE_NAMESPACE
 
 using namespace Qt::StringLiterals;
 
+// The output about the file that is released on this thread, when several
+// files are released concurrently. Each entry tells whether it is an error.
+using BufferedOutput = QList<std::pair<bool, QString>>;
+static thread_local BufferedOutput *bufferedOutput = nullptr;
+
 static void printOut(const QString & out)
 {
+    if (bufferedOutput) {
+        bufferedOutput->append({ false, out });
+        return;
+    }
     QTextStream stream(stdout);
     stream << out;
 }
 
 static void printErr(const QString & out)
 {
+    if (bufferedOutput) {
+        bufferedOutput->append({ true, out });
+        return;
+    }
     QTextStream stream(stderr);
     stream << out;
 }
@@ -67,6 +87,10 @@ Options:
     -project <filename>
            Name of a file containing the project's description in JSON format.
            Such a file may be generated from a .pro file using the lprodump tool.
+    -j <n>
+           Evaluate .pro files and release TS files with up to n threads.
+           TS files are released one at a time if -qm is given.
+           0 uses one thread for each processor core. Default: 1.
     -silent
            Do not explain what is being done
     -version
@@ -91,7 +115,10 @@ static bool loadTsFile(Translator &tor, const QString &tsFileName, bool /* verbo
 static bool releaseTranslator(Translator &tor, const QString &qmFileName,
     ConversionData &cd, bool removeIdentical)
 {
-    tor.reportDuplicates(tor.resolveDuplicates(), qmFileName, cd.isVerbose());
+    std::ostringstream duplicates;
+    tor.reportDuplicates(tor.resolveDuplicates(), qmFileName, cd.isVerbose(), duplicates);
+    if (duplicates.tellp() > 0)
+        printErr(QString::fromLocal8Bit(duplicates.str()));
 
     if (cd.isVerbose())
         printOut(QLatin1String("Updating '%1'...\n").arg(qmFileName));
@@ -141,6 +168,58 @@ static bool releaseTsFile(const QString& tsFileName,
     return releaseTranslator(tor, qmFileName, cd, removeIdentical);
 }
 
+/*
+  Releases the files with up to threadCount threads, each with its own copy
+  of the conversion data. The output about each file is printed in the order
+  of the files, once the files before it are done. All files are released,
+  even if one of them fails.
+*/
+static bool releaseTsFiles(const QStringList &tsFileNames, const ConversionData &cd,
+                           bool removeIdentical, int threadCount)
+{
+    struct Result
+    {
+        BufferedOutput output;
+        bool ok = false;
+        bool done = false;
+    };
+    std::vector<Result> results(tsFileNames.size());
+    std::atomic<qsizetype> nextFile{0};
+    std::mutex mutex;
+    qsizetype printed = 0;
+    bool ok = true;
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        workers.emplace_back([&] {
+            for (qsizetype index; (index = nextFile++) < tsFileNames.size();) {
+                ConversionData fileCd = cd;
+                bufferedOutput = &results[index].output;
+                const bool released = releaseTsFile(tsFileNames.at(index), fileCd,
+                                                    removeIdentical);
+                bufferedOutput = nullptr;
+
+                std::lock_guard<std::mutex> lock(mutex);
+                results[index].ok = released;
+                results[index].done = true;
+                for (; printed < tsFileNames.size() && results[printed].done; ++printed) {
+                    for (const auto &[isError, text] : std::as_const(results[printed].output)) {
+                        if (isError)
+                            printErr(text);
+                        else
+                            printOut(text);
+                    }
+                    ok = ok && results[printed].ok;
+                }
+            }
+        });
+    }
+    for (std::thread &worker : workers)
+        worker.join();
+    return ok;
+}
+
 static QStringList translationsFromProjects(const Projects &projects, bool topLevel);
 
 static QStringList translationsFromProject(const Project &project, bool topLevel)
@@ -172,6 +251,7 @@ int main(int argc, char **argv)
     ConversionData cd;
     cd.m_verbose = true; // the default is true starting with Qt 4.2
     bool removeIdentical = false;
+    int threadCount = 1;
     Translator tor;
     QStringList inputFiles;
     QString outputFile;
@@ -209,6 +289,19 @@ int main(int argc, char **argv)
                 return 1;
             }
             projectDescriptionFile = QString::fromLocal8Bit(argv[++i]);
+        } else if (!strcmp(argv[i], "-j")) {
+            if (i == argc - 1) {
+                printErr(QLatin1String("The option -j requires a parameter.\n"));
+                return 1;
+            }
+            bool ok = false;
+            threadCount = QString::fromLocal8Bit(argv[++i]).toInt(&ok);
+            if (!ok || threadCount < 0) {
+                printErr(QLatin1String("Invalid number of threads passed to -j.\n"));
+                return 1;
+            }
+            if (threadCount == 0)
+                threadCount = qMax(1, int(std::thread::hardware_concurrency()));
         } else if (!strcmp(argv[i], "-silent")) {
             cd.m_verbose = false;
             continue;
@@ -241,12 +334,48 @@ int main(int argc, char **argv)
     }
 
     QString errorString;
-    if (!extractProFiles(&inputFiles).isEmpty()) {
-        runInternalQtTool(QLatin1String("lrelease-pro"), app.arguments().mid(1));
-        return 0;
-    }
-
-    if (!projectDescriptionFile.isEmpty()) {
+    QStringList proFiles = extractProFiles(&inputFiles);
+    if (!proFiles.isEmpty()) {
+        if (!projectDescriptionFile.isEmpty()) {
+            printErr(QLatin1String(
+                    "lrelease error: Do not specify .pro files if -project is given.\n"));
+            return 1;
+        }
+        if (!inputFiles.isEmpty()) {
+            printErr(QLatin1String("lrelease error: Do not specify TS files together with"
+                                   " .pro files. Offending files:\n    %1\n")
+                     .arg(inputFiles.join(QLatin1String("\n    "))));
+            return 1;
+        }
+        // Evaluate the qmake projects in this process instead of passing them
+        // through lrelease-pro and lprodump.
+        QHash<QString, QString> outDirMap;
+        for (QString &proFile : proFiles) {
+            QFileInfo fi(proFile);
+            if (!fi.exists()) {
+                printErr(QLatin1String("lrelease error: File '%1' does not exist.\n")
+                         .arg(proFile));
+                return 1;
+            }
+            proFile = QDir::cleanPath(fi.absoluteFilePath());
+            outDirMap[proFile] = QDir::currentPath();
+        }
+        ProjectDumper dumper;
+        dumper.setVerbose(cd.isVerbose());
+        dumper.setThreadCount(threadCount);
+        dumper.setTranslationsVariables({ QStringLiteral("TRANSLATIONS"),
+                                          QStringLiteral("EXTRA_TRANSLATIONS") });
+        bool fail = false;
+        const QJsonArray rawProjects = dumper.dump(proFiles, outDirMap, &fail);
+        if (fail)
+            return 1;
+        Projects projectDescription = readProjectDescription(rawProjects, &errorString);
+        if (!errorString.isEmpty()) {
+            printErr(QLatin1String("lrelease error: %1\n").arg(errorString));
+            return 1;
+        }
+        inputFiles = translationsFromProjects(projectDescription);
+    } else if (!projectDescriptionFile.isEmpty()) {
         if (!inputFiles.isEmpty()) {
             printErr(QLatin1String(
                     "lrelease error: Do not specify TS files if -project is given.\n"));
@@ -260,6 +389,10 @@ int main(int argc, char **argv)
         inputFiles = translationsFromProjects(projectDescription);
     }
 
+    threadCount = int(qMin(qsizetype(threadCount), inputFiles.size()));
+    if (outputFile.isEmpty() && threadCount > 1)
+        return releaseTsFiles(inputFiles, cd, removeIdentical, threadCount) ? 0 : 1;
+
     for (const QString &inputFile : std::as_const(inputFiles)) {
         if (outputFile.isEmpty()) {
             if (!releaseTsFile(inputFile, cd, removeIdentical))
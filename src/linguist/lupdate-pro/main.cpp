@@ -123,9 +123,15 @@ int main(int argc, char **argv)
         return 1;
     }
 
+    // lupdate evaluates the projects itself, unless the project description
+    // is to be kept.
+    if (!keepProjectDescription) {
+        runQtTool(QStringLiteral("lupdate"), args.mid(1));
+        return 0;
+    }
+
     std::unique_ptr<QTemporaryFile> projectDescription = createProjectDescription(lprodumpOptions);
-    if (keepProjectDescription)
-        projectDescription->setAutoRemove(false);
+    projectDescription->setAutoRemove(false);
     lupdateOptions << QStringLiteral("-project") << projectDescription->fileName();
 
     runQtTool(QStringLiteral("lupdate"), lupdateOptions);
@@ -2,12 +2,19 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
 
 #include "cpp.h"
+#include "extractioncache.h"
 
 #include <translator.h>
 #include <QtCore/QBitArray>
 #include <QtCore/QTextStream>
 #include <QtCore/QRegularExpression>
 
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
 
@@ -47,7 +54,9 @@ QDebug operator<<(QDebug debug, const HashStringList &lst)
     return debug << lst.m_list;
 }
 
-static int nextFileId;
+static thread_local int nextFileId;
+// The files that the file being parsed depends on, if they are recorded.
+static thread_local QSet<QString> *currentDependencies = nullptr;
 
 class VisitRecorder {
 public:
@@ -234,7 +243,7 @@ CppParser::CppParser(ParseResults *_results)
 
 std::ostream &CppParser::yyMsg(int line)
 {
-    return std::cerr << qPrintable(yyFileName) << ':' << (line ? line : yyLineNo) << ": ";
+    return *messageStream << qPrintable(yyFileName) << ':' << (line ? line : yyLineNo) << ": ";
 }
 
 void CppParser::setInput(const QString &in)
@@ -1177,25 +1186,32 @@ size_t qHash(const ResultsCacheKey &key, size_t seed)
 
 IncludeCycleHash &CppFiles::includeCycles()
 {
-    static IncludeCycleHash cycles;
+    static thread_local IncludeCycleHash cycles;
 
     return cycles;
 }
 
 TranslatorHash &CppFiles::translatedFiles()
 {
-    static TranslatorHash tors;
+    static thread_local TranslatorHash tors;
 
     return tors;
 }
 
 QSet<QString> &CppFiles::blacklistedFiles()
 {
-    static QSet<QString> blacklisted;
+    static thread_local QSet<QString> blacklisted;
 
     return blacklisted;
 }
 
+QHash<QString, QSet<QString>> &CppFiles::dependencies()
+{
+    static thread_local QHash<QString, QSet<QString>> dependencies;
+
+    return dependencies;
+}
+
 QSet<const ParseResults *> CppFiles::getResults(const ResultsCacheKey &key)
 {
     IncludeCycle * const cycle = includeCycles().value(key);
@@ -1239,6 +1255,16 @@ void CppFiles::setBlacklisted(const QString &cleanFile)
     blacklistedFiles().insert(cleanFile);
 }
 
+QSet<QString> CppFiles::getDependencies(const QString &cleanFile)
+{
+    return dependencies().value(cleanFile);
+}
+
+void CppFiles::addDependencies(const QString &cleanFile, const QSet<QString> &files)
+{
+    dependencies()[cleanFile].unite(files);
+}
+
 void CppFiles::addIncludeCycle(const QSet<QString> &fileNames, const CppParserState &parserState)
 {
     IncludeCycle * const cycle = new IncludeCycle;
@@ -1278,10 +1304,15 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
             return;
     }
 
+    if (currentDependencies)
+        currentDependencies->insert(cleanFile);
+
     const int index = includeStack.indexOf(cleanFile);
     if (index != -1) {
-        CppFiles::addIncludeCycle(QSet<QString>(includeStack.cbegin() + index, includeStack.cend()),
-                                  *this);
+        const QSet<QString> cycle(includeStack.cbegin() + index, includeStack.cend());
+        CppFiles::addIncludeCycle(cycle, *this);
+        if (currentDependencies)
+            currentDependencies->unite(cycle);
         return;
     }
 
@@ -1296,6 +1327,8 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
         QSet<const ParseResults *> res = CppFiles::getResults(ResultsCacheKey(cleanFile, *this));
         if (!res.isEmpty()) {
             results->includes.unite(res);
+            if (currentDependencies)
+                currentDependencies->unite(CppFiles::getDependencies(cleanFile));
             return;
         }
 
@@ -1324,7 +1357,18 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
         parser.setInput(ts, cleanFile);
         QStringList stack = includeStack;
         stack << cleanFile;
+        // Record the dependencies of the header separately, for when its
+        // results are reused.
+        QSet<QString> dependencies;
+        QSet<QString> *parentDependencies = currentDependencies;
+        if (parentDependencies)
+            currentDependencies = &dependencies;
         parser.parse(cd, stack, inclusions);
+        currentDependencies = parentDependencies;
+        if (currentDependencies) {
+            CppFiles::addDependencies(cleanFile, dependencies);
+            currentDependencies->unite(dependencies);
+        }
         results->includes.insert(parser.recordResults(true));
     } else {
         CppParser parser(results);
@@ -1703,6 +1747,9 @@ void CppParser::parseInternal(ConversionData &cd, const QStringList &includeStac
                 yyTok = getToken();
                 break;
             }
+            // Creating the file would change the result.
+            if (currentDependencies)
+                currentDependencies->insert(QDir::cleanPath(text));
         }
         Q_FALLTHROUGH();
         case Tok_AngledInclude: {
@@ -1719,6 +1766,9 @@ void CppParser::parseInternal(ConversionData &cd, const QStringList &includeStac
                     processInclude(text, cd, includeStack, inclusions);
                     goto incOk;
                 }
+                // Creating the file would change the result.
+                if (currentDependencies)
+                    currentDependencies->insert(QDir::cleanPath(text));
             }
           incOk:
             yyTok = getToken();
@@ -2262,39 +2312,146 @@ const ParseResults *CppParser::recordResults(bool isHeader)
     }
 }
 
-void loadCPP(Translator &translator, const QStringList &filenames, ConversionData &cd)
+static void loadCppFile(const QString &filename, QStringConverter::Encoding e, ConversionData &cd,
+                        QString *error)
 {
-    QStringConverter::Encoding e = cd.m_sourceIsUtf16 ? QStringConverter::Utf16 : QStringConverter::Utf8;
-
-    for (const QString &filename : filenames) {
-        if (!CppFiles::getResults(ResultsCacheKey(filename)).isEmpty() || CppFiles::isBlacklisted(filename))
-            continue;
+    if (!CppFiles::getResults(ResultsCacheKey(filename)).isEmpty() || CppFiles::isBlacklisted(filename))
+        return;
 
-        QFile file(filename);
-        if (!file.open(QIODevice::ReadOnly)) {
-            cd.appendError(QStringLiteral("Cannot open %1: %2").arg(filename,
-                                                                    file.errorString()));
-            continue;
+    ExtractionCache *cache = ExtractionCache::the();
+    ExtractionCache::Entry entry;
+    if (cache && cache->load(filename, &entry)) {
+        *messageStream << entry.warnings.constData();
+        for (const QString &blacklisted : std::as_const(entry.blacklisted))
+            CppFiles::setBlacklisted(blacklisted);
+        if (!entry.messages.isEmpty()) {
+            Translator *tor = new Translator;
+            for (const TranslatorMessage &msg : std::as_const(entry.messages))
+                tor->append(msg);
+            CppFiles::setTranslator(filename, tor);
         }
+        return;
+    }
 
-        CppParser parser;
-        QTextStream ts(&file);
-        ts.setEncoding(e);
-        ts.setAutoDetectUnicode(true);
-        parser.setInput(ts, filename);
-        Translator *tor = new Translator;
-        parser.setTranslator(tor);
-        QSet<QString> inclusions;
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QStringLiteral("Cannot open %1: %2").arg(filename, file.errorString());
+        return;
+    }
+
+    CppParser parser;
+    QTextStream ts(&file);
+    ts.setEncoding(e);
+    ts.setAutoDetectUnicode(true);
+    parser.setInput(ts, filename);
+    Translator *tor = new Translator;
+    parser.setTranslator(tor);
+    QSet<QString> inclusions;
+    if (!cache) {
         parser.parse(cd, QStringList(), inclusions);
         parser.recordResults(isHeader(filename));
+        return;
+    }
+
+    const QSet<QString> blacklisted = CppFiles::blacklisted();
+    QSet<QString> dependencies;
+    currentDependencies = &dependencies;
+    std::ostream *out = messageStream;
+    std::ostringstream warnings;
+    messageStream = &warnings;
+    parser.parse(cd, QStringList(), inclusions);
+    messageStream = out;
+    currentDependencies = nullptr;
+    entry.warnings = QByteArray::fromStdString(warnings.str());
+    *messageStream << entry.warnings.constData();
+    entry.messages = tor->messages();
+    parser.recordResults(isHeader(filename));
+
+    CppFiles::addDependencies(filename, dependencies);
+    dependencies.remove(filename);
+    entry.dependencies = QStringList(dependencies.cbegin(), dependencies.cend());
+    entry.dependencies.sort();
+    const QSet<QString> newlyBlacklisted = CppFiles::blacklisted().subtract(blacklisted);
+    entry.blacklisted = QStringList(newlyBlacklisted.cbegin(), newlyBlacklisted.cend());
+    cache->save(filename, entry);
+}
+
+void loadCPP(Translator &translator, const QStringList &filenames, ConversionData &cd,
+             int threadCount)
+{
+    QStringConverter::Encoding e = cd.m_sourceIsUtf16 ? QStringConverter::Utf16 : QStringConverter::Utf8;
+
+    threadCount = int(qMin(qsizetype(threadCount), filenames.size()));
+    if (threadCount <= 1) {
+        for (const QString &filename : filenames) {
+            QString error;
+            loadCppFile(filename, e, cd, &error);
+            if (!error.isEmpty())
+                cd.appendError(error);
+        }
+
+        for (const QString &filename : filenames) {
+            if (!CppFiles::isBlacklisted(filename)) {
+                if (const Translator *tor = CppFiles::getTranslator(filename)) {
+                    for (const TranslatorMessage &msg : tor->messages())
+                        translator.extend(msg, cd);
+                }
+            }
+        }
+        return;
     }
 
-    for (const QString &filename : filenames) {
-        if (!CppFiles::isBlacklisted(filename)) {
-            if (const Translator *tor = CppFiles::getTranslator(filename)) {
-                for (const TranslatorMessage &msg : tor->messages())
-                    translator.extend(msg, cd);
+    // The workers pick the next file from a shared counter. As the CppFiles caches
+    // are thread-local, a header that is included by files handled by different
+    // workers is parsed once by each of them. Everything that is shared is set up
+    // here, so that the workers only read it.
+    trFunctionAliasManager.nameToTrFunctionMap();
+    for (const QRegularExpression &rx : std::as_const(cd.m_excludes))
+        rx.optimize();
+
+    std::vector<const Translator *> tors(filenames.size(), nullptr);
+    std::vector<QString> errors(filenames.size());
+    QSet<QString> blacklisted;
+    std::atomic<qsizetype> nextFile{0};
+    std::mutex mutex;
+
+    // The warnings go where those of this thread go.
+    std::ostream &out = *messageStream;
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        workers.emplace_back([&] {
+            TranslatorMessage::InternScope internScope;
+            std::ostringstream messages;
+            messageStream = &messages;
+            for (qsizetype index; (index = nextFile++) < filenames.size();) {
+                const QString &filename = filenames.at(index);
+                loadCppFile(filename, e, cd, &errors[index]);
+                tors[index] = CppFiles::getTranslator(filename);
+
+                // Keep the warnings about one file together.
+                if (messages.tellp() > 0) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    out << messages.str();
+                    messages.str(std::string());
+                }
             }
+            messageStream = &std::cerr;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            blacklisted.unite(CppFiles::blacklisted());
+        });
+    }
+    for (std::thread &worker : workers)
+        worker.join();
+
+    // Merge in input order, so that the result is the same as for a single thread.
+    for (qsizetype i = 0; i < filenames.size(); ++i) {
+        if (!errors[i].isEmpty())
+            cd.appendError(errors[i]);
+        if (tors[i] && !blacklisted.contains(filenames.at(i))) {
+            for (const TranslatorMessage &msg : tors[i]->messages())
+                translator.extend(msg, cd);
         }
     }
 }
@@ -132,6 +132,8 @@ size_t qHash(const ResultsCacheKey &key, size_t seed);
 typedef QHash<ResultsCacheKey, IncludeCycle *> IncludeCycleHash;
 typedef QHash<QString, const Translator *> TranslatorHash;
 
+// The caches are kept per thread, so that loadCPP() can run several
+// parsers at once without synchronizing every lookup.
 class CppFiles {
 public:
     static QSet<const ParseResults *> getResults(const ResultsCacheKey &key);
@@ -140,12 +142,16 @@ public:
     static void setTranslator(const QString &cleanFile, const Translator *results);
     static bool isBlacklisted(const QString &cleanFile);
     static void setBlacklisted(const QString &cleanFile);
+    static QSet<QString> blacklisted() { return blacklistedFiles(); }
+    static QSet<QString> getDependencies(const QString &cleanFile);
+    static void addDependencies(const QString &cleanFile, const QSet<QString> &dependencies);
     static void addIncludeCycle(const QSet<QString> &fileNames, const CppParserState &parserState);
 
 private:
     static IncludeCycleHash &includeCycles();
     static TranslatorHash &translatedFiles();
     static QSet<QString> &blacklistedFiles();
+    static QHash<QString, QSet<QString>> &dependencies();
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,213 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "extractioncache.h"
+#include "lupdate.h"
+
+#include <translator.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qsavefile.h>
+
+QT_BEGIN_NAMESPACE
+
+using namespace Qt::StringLiterals;
+
+/*
+ * The cache keeps one entry per source file, named after a hash of the file's
+ * path. An entry records the hash of the options that affect the extraction,
+ * the hash of the file's contents, the hashes of the files it depends on, and
+ * the extracted messages. It is used as long as all of these still match.
+ *
+ * Entries are written with QSaveFile, so that concurrent or interrupted runs
+ * never leave a partial entry behind.
+ */
+
+ExtractionCache *ExtractionCache::m_instance = nullptr;
+
+static const quint32 cacheMagic = 0x4c555043; // "LUPC"
+static const quint32 cacheVersion = 1;
+
+static QStringList sortedList(QStringList list)
+{
+    list.sort();
+    return list;
+}
+
+/*
+ * Sets the options that the entries loaded and saved next depend on, from
+ * the conversion data of the project whose sources are processed.
+ */
+void ExtractionCache::setOptions(const ConversionData &cd)
+{
+    QByteArray options;
+    QDataStream out(&options, QIODevice::WriteOnly);
+    out << QStringLiteral(QT_VERSION_STR) << trFunctionAliasManager.listAliases()
+        << cd.m_sourceIsUtf16 << cd.m_noUiLines << cd.m_defaultContext << cd.m_includePath
+        << sortedList(QStringList(cd.m_projectRoots.cbegin(), cd.m_projectRoots.cend()));
+    QStringList excludes;
+    for (const QRegularExpression &rx : cd.m_excludes)
+        excludes << rx.pattern();
+    out << excludes;
+    QStringList cSources;
+    for (auto it = cd.m_allCSources.cbegin(); it != cd.m_allCSources.cend(); ++it)
+        cSources << it.key() + u'\n' + it.value();
+    out << sortedList(cSources);
+
+    m_options = QCryptographicHash::hash(options, QCryptographicHash::Sha1);
+}
+
+QString ExtractionCache::entryPath(const QString &fileName) const
+{
+    const QByteArray key = QCryptographicHash::hash(QDir::cleanPath(fileName).toUtf8(),
+                                                    QCryptographicHash::Sha1);
+    return m_directory + u'/' + QString::fromLatin1(key.toHex()) + ".lucache"_L1;
+}
+
+/*
+ * Returns the hash of the contents of \a fileName, or an empty hash if the
+ * file cannot be read. The hash of each file is computed only once per run.
+ *
+ * This method is called from multiple threads.
+ */
+QByteArray ExtractionCache::contentHash(const QString &fileName)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_contentHashes.constFind(fileName);
+        if (it != m_contentHashes.cend())
+            return *it;
+    }
+
+    QByteArray hash;
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly)) {
+        QCryptographicHash hasher(QCryptographicHash::Sha1);
+        if (hasher.addData(&file))
+            hash = hasher.result();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_contentHashes.insert(fileName, hash);
+    return hash;
+}
+
+static QDataStream &operator<<(QDataStream &out, const TranslatorMessage &msg)
+{
+    out << msg.id() << msg.context() << msg.sourceText() << msg.oldSourceText() << msg.comment()
+        << msg.oldComment() << msg.userData() << msg.extras() << msg.extraComment()
+        << msg.translatorComment() << msg.warning() << msg.warningOnly() << msg.translations()
+        << qint32(msg.type()) << msg.isPlural();
+    const TranslatorMessage::References refs = msg.allReferences();
+    out << qint32(refs.size());
+    for (const TranslatorMessage::Reference &ref : refs)
+        out << ref.fileName() << qint32(ref.lineNumber());
+    return out;
+}
+
+static QDataStream &operator>>(QDataStream &in, TranslatorMessage &msg)
+{
+    QString id, context, sourceText, oldSourceText, comment, oldComment, userData;
+    QString extraComment, translatorComment, warning;
+    TranslatorMessage::ExtraData extras;
+    QStringList translations;
+    bool warningOnly, plural;
+    qint32 type, refCount;
+    in >> id >> context >> sourceText >> oldSourceText >> comment >> oldComment >> userData
+        >> extras >> extraComment >> translatorComment >> warning >> warningOnly >> translations
+        >> type >> plural >> refCount;
+
+    TranslatorMessage::References refs;
+    for (qint32 i = 0; i < refCount && in.status() == QDataStream::Ok; ++i) {
+        QString fileName;
+        qint32 lineNumber;
+        in >> fileName >> lineNumber;
+        refs.append(TranslatorMessage::Reference(fileName, lineNumber));
+    }
+
+    msg = TranslatorMessage(context, sourceText, comment, userData, QString(), -1, translations,
+                            TranslatorMessage::Type(type), plural);
+    msg.setId(id);
+    msg.setOldSourceText(oldSourceText);
+    msg.setOldComment(oldComment);
+    msg.setExtras(extras);
+    msg.setExtraComment(extraComment);
+    msg.setTranslatorComment(translatorComment);
+    msg.setWarning(warning);
+    msg.setWarningOnly(warningOnly);
+    msg.setReferences(refs);
+    return in;
+}
+
+/*
+ * Reads the entry of \a fileName into \a entry. Returns false if there is no
+ * entry, or if the file, one of its dependencies, or the options changed since
+ * the entry was saved.
+ */
+bool ExtractionCache::load(const QString &fileName, Entry *entry)
+{
+    QFile file(entryPath(fileName));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic, version;
+    QString storedFileName;
+    QByteArray options, hash;
+    in >> magic >> version;
+    if (magic != cacheMagic || version != cacheVersion)
+        return false;
+    in >> storedFileName >> options >> hash;
+    if (storedFileName != fileName || options != m_options || hash != contentHash(fileName))
+        return false;
+
+    qint32 count;
+    in >> count;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString dependency;
+        in >> dependency >> hash;
+        if (hash != contentHash(dependency))
+            return false;
+        entry->dependencies << dependency;
+    }
+
+    in >> entry->blacklisted >> entry->warnings >> count;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        TranslatorMessage msg;
+        in >> msg;
+        entry->messages << msg;
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+/*
+ * Stores \a entry as the entry of \a fileName. Failures are ignored, as they
+ * only cause the file to be parsed again the next time.
+ */
+void ExtractionCache::save(const QString &fileName, const Entry &entry)
+{
+    if (!QDir().mkpath(m_directory))
+        return;
+
+    QSaveFile file(entryPath(fileName));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << cacheMagic << cacheVersion << fileName << m_options << contentHash(fileName);
+    out << qint32(entry.dependencies.size());
+    for (const QString &dependency : entry.dependencies)
+        out << dependency << contentHash(dependency);
+    out << entry.blacklisted << entry.warnings << qint32(entry.messages.size());
+    for (const TranslatorMessage &msg : entry.messages)
+        out << msg;
+    if (out.status() == QDataStream::Ok)
+        file.commit();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,72 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef EXTRACTIONCACHE_H
+#define EXTRACTIONCACHE_H
+
+#include <translatormessage.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+
+QT_BEGIN_NAMESPACE
+
+class ConversionData;
+
+class ExtractionCache
+{
+public:
+    struct Entry
+    {
+        // The messages as extracted, with one location each.
+        QList<TranslatorMessage> messages;
+        // Files other than the source file itself that the messages depend on.
+        QStringList dependencies;
+        // Files that were included directly, see CppFiles::setBlacklisted().
+        QStringList blacklisted;
+        // The warnings printed while extracting, to be printed again whenever
+        // the entry is used.
+        QByteArray warnings;
+    };
+
+    explicit ExtractionCache(const QString &directory) : m_directory(directory) {}
+
+    static void create(const QString &directory)
+    {
+        m_instance = new ExtractionCache(directory);
+    }
+
+    static void destroy()
+    {
+        delete m_instance;
+        m_instance = nullptr;
+    }
+
+    static ExtractionCache *the()
+    {
+        return m_instance;
+    }
+
+    void setOptions(const ConversionData &cd);
+
+    bool load(const QString &fileName, Entry *entry);
+    void save(const QString &fileName, const Entry &entry);
+
+private:
+    QString entryPath(const QString &fileName) const;
+    QByteArray contentHash(const QString &fileName);
+
+    static ExtractionCache *m_instance;
+    const QString m_directory;
+    QByteArray m_options;
+    QHash<QString, QByteArray> m_contentHashes;
+    QMutex m_mutex;
+};
+
+QT_END_NAMESPACE
+
+#endif // EXTRACTIONCACHE_H
@@ -14,6 +14,8 @@
 #include <QtCore/QStringList>
 #include <QtCore/QTranslator>
 
+#include <iosfwd>
+
 QT_BEGIN_NAMESPACE
 
 class ConversionData;
@@ -42,7 +44,8 @@ Translator merge(
     const Translator &tor, const Translator &virginTor, const QList<Translator> &aliens,
     UpdateOptions options, QString &err);
 
-void loadCPP(Translator &translator, const QStringList &filenames, ConversionData &cd);
+void loadCPP(Translator &translator, const QStringList &filenames, ConversionData &cd,
+             int threadCount = 1);
 bool loadJava(Translator &translator, const QString &filename, ConversionData &cd);
 bool loadPython(Translator &translator, const QString &fileName, ConversionData &cd);
 bool loadUI(Translator &translator, const QString &filename, ConversionData &cd);
@@ -125,4 +128,9 @@ QT_END_NAMESPACE
 
 extern QT_PREPEND_NAMESPACE(TrFunctionAliasManager) trFunctionAliasManager;
 
+// Where the parsers write their warnings. Threads that parse files while
+// others do the same point it to a buffer, so that the warnings can be
+// printed in the order of the files.
+extern thread_local std::ostream *messageStream;
+
 #endif
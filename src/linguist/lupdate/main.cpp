@@ -2,6 +2,7 @@
 // Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com, author Marc Mutz <marc.mutz@kdab.com>
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
 
+#include "extractioncache.h"
 #include "lupdate.h"
 #if QT_CONFIG(clangcpp)
 #include "cpp_clang.h"
@@ -9,8 +10,8 @@
 
 #include <profileutils.h>
 #include <projectdescriptionreader.h>
+#include <projectdumper.h>
 #include <qrcreader.h>
-#include <runqttool.h>
 #include <translator.h>
 
 #include <QtCore/QCoreApplication>
@@ -23,7 +24,13 @@
 #include <QtCore/QStringList>
 #include <QtCore/QTranslator>
 
+#include <atomic>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 using namespace Qt::StringLiterals;
 
@@ -31,6 +38,7 @@ bool useClangToParseCpp = false;
 QString commandLineCompilationDatabaseDir; // for the path to the json file passed as a command line argument.
                                     // Has priority over what is in the .pro file and passed to the project.
 QStringList rootDirs;
+static int threadCount = 1;
 
 // Can't have an array of QStaticStringData<N> for different N, so
 // use QString, which requires constructor calls. Doesn't matter
@@ -136,6 +144,7 @@ QStringList TrFunctionAliasManager::listAliases() const
 }
 
 TrFunctionAliasManager trFunctionAliasManager;
+thread_local std::ostream *messageStream = &std::cerr;
 
 QString ParserTool::transcode(const QString &str)
 {
@@ -200,10 +209,10 @@ static void printErr(const QString & out)
     std::cerr << qPrintable(out);
 }
 
-static void printWarning(UpdateOptions options,
-                         const QString &msg,
-                         const QString &warningMsg = {},
-                         const QString &errorMsg = {})
+static QString warningText(UpdateOptions options,
+                           const QString &msg,
+                           const QString &warningMsg = {},
+                           const QString &errorMsg = {})
 {
     QString text = msg;
     if (options & Werror) {
@@ -215,8 +224,15 @@ static void printWarning(UpdateOptions options,
         if (!warningMsg.isEmpty())
             text.append(" "_L1).append(warningMsg);
     }
+    return text;
+}
 
-    printErr(text);
+static void printWarning(UpdateOptions options,
+                         const QString &msg,
+                         const QString &warningMsg = {},
+                         const QString &errorMsg = {})
+{
+    printErr(warningText(options, msg, warningMsg, errorMsg));
 }
 
 static void recursiveFileInfoList(const QDir &dir,
@@ -262,6 +278,16 @@ static void printUsage()
         "           Recursively scan directories (default).\n"
         "    -warnings-are-errors\n"
         "           Treat warnings as errors.\n"
+        "    -j <n>\n"
+        "           Evaluate .pro files, extract messages from source files and update\n"
+        "           TS files with up to n threads. C++ files are parsed with one thread\n"
+        "           when using the clang parser.\n"
+        "           0 uses one thread for each processor core. Default: 1.\n"
+        "    -cache-dir <directory>\n"
+        "           Store the messages extracted from each source file in this directory,\n"
+        "           and reuse them as long as the file, the files it includes, and the\n"
+        "           options affecting the extraction do not change. C++ files are only\n"
+        "           cached when not using the clang parser.\n"
         "    -I <includepath> or -I<includepath>\n"
         "           Additional location to look for include files.\n"
         "           May be specified multiple times.\n"
@@ -356,64 +382,156 @@ static bool handleTrFunctionAliases(const QString &arg)
     return true;
 }
 
-static void updateTsFiles(const Translator &fetchedTor, const QStringList &tsFileNames,
-    const QStringList &alienFiles,
-    const QString &sourceLanguage, const QString &targetLanguage,
-    UpdateOptions options, bool *fail)
+/*
+  Updates the .ts files of a project with up to maxThreads threads, which only
+  read the fetched and the alien translators. The output about each file is
+  collected and printed in the order of the files, as soon as the files before
+  it are done. As when updating one file after the other, a warning that is
+  turned into an error by -warnings-are-errors prevents its file and all the
+  following ones from being saved.
+*/
+class TsFilesUpdater
 {
-    for (int i = 0; i < fetchedTor.messageCount(); i++) {
-        const TranslatorMessage &msg = fetchedTor.constMessage(i);
-        if (!msg.id().isEmpty() && msg.sourceText().isEmpty()) {
-            printWarning(options,
-                         "Message with id '%1' has no source.\n"_L1.arg(msg.id()));
-            if (options & Werror)
-                return;
+public:
+    TsFilesUpdater(const Translator &fetchedTor, const QList<Translator> &aliens,
+                   const QStringList &tsFileNames, const QString &sourceLanguage,
+                   const QString &targetLanguage, UpdateOptions options)
+        : m_fetchedTor(fetchedTor),
+          m_aliens(aliens),
+          m_tsFileNames(tsFileNames),
+          m_sourceLanguage(sourceLanguage),
+          m_targetLanguage(targetLanguage),
+          m_options(options),
+          m_files(tsFileNames.size()),
+          m_firstStopped(tsFileNames.size())
+    {
+    }
+
+    // Returns false if a file that was processed could not be loaded or saved.
+    bool run(int maxThreads)
+    {
+        const int threads = int(qMin(qsizetype(maxThreads), m_tsFileNames.size()));
+        if (threads <= 1) {
+            for (qsizetype i = 0; i < m_tsFileNames.size() && i <= m_firstStopped; ++i)
+                process(i);
+        } else {
+            m_fetchedTor.buildIndexes();
+            std::atomic<qsizetype> nextFile{0};
+            std::vector<std::thread> workers;
+            workers.reserve(threads);
+            for (int i = 0; i < threads; ++i) {
+                workers.emplace_back([&] {
+                    for (qsizetype index; (index = nextFile++) < m_tsFileNames.size();)
+                        process(index);
+                });
+            }
+            for (std::thread &worker : workers)
+                worker.join();
+        }
+
+        for (qsizetype i = 0; i < m_tsFileNames.size() && i <= m_firstStopped; ++i) {
+            if (m_files[i].fail)
+                return false;
         }
+        return true;
     }
-    QList<Translator> aliens;
-    for (const QString &fileName : alienFiles) {
-        ConversionData cd;
-        Translator tor;
-        if (!tor.load(fileName, cd, QLatin1String("auto"))) {
-            printErr(cd.error());
-            *fail = true;
-            continue;
+
+private:
+    struct File
+    {
+        QList<std::pair<bool, QString>> output; // Whether it is an error, and the text
+        bool fail = false;
+        bool checked = false;
+        bool done = false;
+    };
+
+    void process(qsizetype index)
+    {
+        update(index, &m_files[index]);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        markChecked(index, false);
+        m_files[index].done = true;
+        for (; m_printed < m_tsFileNames.size() && m_printed <= m_firstStopped
+               && m_files[m_printed].done; ++m_printed) {
+            for (const auto &[isError, text] : std::as_const(m_files[m_printed].output)) {
+                if (isError)
+                    printErr(text);
+                else
+                    printOut(text);
+            }
         }
-        tor.resolveDuplicates();
-        aliens << tor;
     }
-    QDir dir;
-    QString err;
-    for (const QString &fileName : tsFileNames) {
-        QString fn = dir.relativeFilePath(fileName);
+
+    // Records that the checks that may stop the update of a file are done.
+    // Requires m_mutex to be locked.
+    void markChecked(qsizetype index, bool stop)
+    {
+        if (m_files[index].checked)
+            return;
+        m_files[index].checked = true;
+        if (stop)
+            m_firstStopped = qMin(m_firstStopped, index);
+        while (m_checkedCount < m_tsFileNames.size() && m_files[m_checkedCount].checked)
+            ++m_checkedCount;
+        m_checkedChanged.notify_all();
+    }
+
+    void setChecked(qsizetype index, bool stop)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        markChecked(index, stop);
+    }
+
+    // Returns whether the file may be saved, once the files before it are checked.
+    bool maySave(qsizetype index)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_checkedChanged.wait(lock, [&] {
+            return m_checkedCount >= index || m_firstStopped < index;
+        });
+        return m_firstStopped > index;
+    }
+
+    void update(qsizetype index, File *file)
+    {
+        const auto out = [file](const QString &text) { file->output.append({ false, text }); };
+        const auto err = [file](const QString &text) { file->output.append({ true, text }); };
+
+        const QString &fileName = m_tsFileNames.at(index);
+        QString fn = QDir().relativeFilePath(fileName);
         ConversionData cd;
         Translator tor;
-        cd.m_sortContexts = !(options & NoSort);
+        cd.m_sortContexts = !(m_options & NoSort);
         if (QFile(fileName).exists()) {
             if (!tor.load(fileName, cd, QLatin1String("auto"))) {
-                printErr(cd.error());
-                *fail = true;
-                continue;
+                err(cd.error());
+                file->fail = true;
+                return;
             }
             tor.resolveDuplicates();
             cd.clearErrors();
-            if (!targetLanguage.isEmpty() && targetLanguage != tor.languageCode()) {
-                printWarning(options,
-                             "Specified target language '%1' disagrees with"
-                                            " existing file's language '%2'.\n"_L1
-                                     .arg(targetLanguage, tor.languageCode()),
-                             u"Ignoring.\n"_s);
-                if (options & Werror)
+            if (!m_targetLanguage.isEmpty() && m_targetLanguage != tor.languageCode()) {
+                err(warningText(m_options,
+                                "Specified target language '%1' disagrees with"
+                                               " existing file's language '%2'.\n"_L1
+                                        .arg(m_targetLanguage, tor.languageCode()),
+                                u"Ignoring.\n"_s));
+                if (m_options & Werror) {
+                    setChecked(index, true);
                     return;
+                }
             }
-            if (!sourceLanguage.isEmpty() && sourceLanguage != tor.sourceLanguageCode()) {
-                printWarning(options,
-                             "Specified source language '%1' disagrees with"
-                                     " existing file's language '%2'.\n"_L1
-                                     .arg(sourceLanguage, tor.sourceLanguageCode()),
-                             u"Ignoring.\n"_s);
-                if (options & Werror)
+            if (!m_sourceLanguage.isEmpty() && m_sourceLanguage != tor.sourceLanguageCode()) {
+                err(warningText(m_options,
+                                "Specified source language '%1' disagrees with"
+                                        " existing file's language '%2'.\n"_L1
+                                        .arg(m_sourceLanguage, tor.sourceLanguageCode()),
+                                u"Ignoring.\n"_s));
+                if (m_options & Werror) {
+                    setChecked(index, true);
                     return;
+                }
             }
             // If there is translation in the file, the language should be recognized
             // (when the language is not recognized, plural translations are lost)
@@ -423,57 +541,106 @@ static void updateTsFiles(const Translator &fetchedTor, const QStringList &tsFil
                 tor.languageAndTerritory(tor.languageCode(), &l, &c);
                 QStringList forms;
                 if (!getNumerusInfo(l, c, 0, &forms, 0)) {
-                    printErr(QStringLiteral("File %1 won't be updated: it contains translation but the"
+                    err(QStringLiteral("File %1 won't be updated: it contains translation but the"
                     " target language is not recognized\n").arg(fileName));
-                    continue;
+                    return;
                 }
             }
         } else {
-            if (!targetLanguage.isEmpty())
-                tor.setLanguageCode(targetLanguage);
+            if (!m_targetLanguage.isEmpty())
+                tor.setLanguageCode(m_targetLanguage);
             else
                 tor.setLanguageCode(Translator::guessLanguageCodeFromFileName(fileName));
-            if (!sourceLanguage.isEmpty())
-                tor.setSourceLanguageCode(sourceLanguage);
+            if (!m_sourceLanguage.isEmpty())
+                tor.setSourceLanguageCode(m_sourceLanguage);
         }
+        setChecked(index, false);
+
         tor.makeFileNamesAbsolute(QFileInfo(fileName).absoluteDir());
-        if (options & NoLocations)
+        if (m_options & NoLocations)
             tor.setLocationsType(Translator::NoLocations);
-        else if (options & RelativeLocations)
+        else if (m_options & RelativeLocations)
             tor.setLocationsType(Translator::RelativeLocations);
-        else if (options & AbsoluteLocations)
+        else if (m_options & AbsoluteLocations)
             tor.setLocationsType(Translator::AbsoluteLocations);
-        if (options & Verbose)
-            printOut(QStringLiteral("Updating '%1'...\n").arg(fn));
+        if (m_options & Verbose)
+            out(QStringLiteral("Updating '%1'...\n").arg(fn));
 
-        UpdateOptions theseOptions = options;
+        UpdateOptions theseOptions = m_options;
         if (tor.locationsType() == Translator::NoLocations) // Could be set from file
             theseOptions |= NoLocations;
-        Translator out = merge(tor, fetchedTor, aliens, theseOptions, err);
-
-        if ((options & Verbose) && !err.isEmpty()) {
-            printOut(err);
-            err.clear();
-        }
-        if (options & PluralOnly) {
-            if (options & Verbose)
-                printOut(QStringLiteral("Stripping non plural forms in '%1'...\n").arg(fn));
-            out.stripNonPluralForms();
+        QString mergeErr;
+        Translator merged = merge(tor, m_fetchedTor, m_aliens, theseOptions, mergeErr);
+
+        if ((m_options & Verbose) && !mergeErr.isEmpty())
+            out(mergeErr);
+        if (m_options & PluralOnly) {
+            if (m_options & Verbose)
+                out(QStringLiteral("Stripping non plural forms in '%1'...\n").arg(fn));
+            merged.stripNonPluralForms();
         }
-        if (options & NoObsolete)
-            out.stripObsoleteMessages();
-        out.stripEmptyContexts();
+        if (m_options & NoObsolete)
+            merged.stripObsoleteMessages();
+        merged.stripEmptyContexts();
 
-        out.normalizeTranslations(cd);
+        merged.normalizeTranslations(cd);
         if (!cd.errors().isEmpty()) {
-            printErr(cd.error());
+            err(cd.error());
             cd.clearErrors();
         }
-        if (!out.save(fileName, cd, QLatin1String("auto"))) {
+        if (!maySave(index))
+            return;
+        if (!merged.save(fileName, cd, QLatin1String("auto"))) {
+            err(cd.error());
+            file->fail = true;
+        }
+    }
+
+    const Translator &m_fetchedTor;
+    const QList<Translator> &m_aliens;
+    const QStringList &m_tsFileNames;
+    const QString &m_sourceLanguage;
+    const QString &m_targetLanguage;
+    const UpdateOptions m_options;
+
+    std::vector<File> m_files;
+    std::mutex m_mutex;
+    std::condition_variable m_checkedChanged;
+    qsizetype m_checkedCount = 0;
+    qsizetype m_firstStopped;
+    qsizetype m_printed = 0;
+};
+
+static void updateTsFiles(const Translator &fetchedTor, const QStringList &tsFileNames,
+    const QStringList &alienFiles,
+    const QString &sourceLanguage, const QString &targetLanguage,
+    UpdateOptions options, bool *fail)
+{
+    for (int i = 0; i < fetchedTor.messageCount(); i++) {
+        const TranslatorMessage &msg = fetchedTor.constMessage(i);
+        if (!msg.id().isEmpty() && msg.sourceText().isEmpty()) {
+            printWarning(options,
+                         "Message with id '%1' has no source.\n"_L1.arg(msg.id()));
+            if (options & Werror)
+                return;
+        }
+    }
+    QList<Translator> aliens;
+    for (const QString &fileName : alienFiles) {
+        ConversionData cd;
+        Translator tor;
+        if (!tor.load(fileName, cd, QLatin1String("auto"))) {
             printErr(cd.error());
             *fail = true;
+            continue;
         }
+        tor.resolveDuplicates();
+        aliens << tor;
     }
+    TsFilesUpdater updater(fetchedTor, aliens, tsFileNames, sourceLanguage, targetLanguage,
+                           options);
+    if (!updater.run(threadCount))
+        *fail = true;
 }
 
 static bool readFileContent(const QString &filePath, QByteArray *content, QString *errorString)
@@ -554,80 +721,280 @@ static void expandQrcFiles(Project &project)
         project.sources << getResources(qrcFile);
 }
 
-static bool processTs(Translator &fetchedTor, const QString &file, ConversionData &cd)
+static QString translationFormat(const QString &file)
 {
     for (const Translator::FileFormat &fmt : std::as_const(Translator::registeredFileFormats())) {
-        if (file.endsWith(QLatin1Char('.') + fmt.extension, Qt::CaseInsensitive)) {
-            Translator tor;
-            if (tor.load(file, cd, fmt.extension)) {
-                for (TranslatorMessage msg : tor.messages()) {
-                    msg.setType(TranslatorMessage::Unfinished);
-                    msg.setTranslations(QStringList());
-                    msg.setTranslatorComment(QString());
-                    fetchedTor.extend(msg, cd);
-                }
+        if (file.endsWith(QLatin1Char('.') + fmt.extension, Qt::CaseInsensitive))
+            return fmt.extension;
+    }
+    return QString();
+}
+
+static bool processTs(Translator &fetchedTor, const QString &file, ConversionData &cd)
+{
+    const QString format = translationFormat(file);
+    if (format.isEmpty())
+        return false;
+
+    Translator tor;
+    if (tor.load(file, cd, format)) {
+        for (TranslatorMessage msg : tor.messages()) {
+            msg.setType(TranslatorMessage::Unfinished);
+            msg.setTranslations(QStringList());
+            msg.setTranslatorComment(QString());
+            fetchedTor.extend(msg, cd);
+        }
+    }
+    return true;
+}
+
+template <typename Loader>
+static void loadSource(Loader load, Translator &fetchedTor, const QString &sourceFile,
+                       ConversionData &cd)
+{
+    ExtractionCache *cache = ExtractionCache::the();
+    if (!cache) {
+        load(fetchedTor, sourceFile, cd);
+        return;
+    }
+
+    ExtractionCache::Entry entry;
+    if (!cache->load(sourceFile, &entry)) {
+        // Keep the messages as they are extracted, one per location, so that they
+        // extend fetchedTor in the same way as without the cache.
+        Translator tor;
+        tor.setExtendLog(&entry.messages);
+        std::ostream *out = messageStream;
+        std::ostringstream warnings;
+        messageStream = &warnings;
+        const qsizetype errorCount = cd.errors().size();
+        load(tor, sourceFile, cd);
+        messageStream = out;
+        entry.warnings = QByteArray::fromStdString(warnings.str());
+        if (cd.errors().size() == errorCount)
+            cache->save(sourceFile, entry);
+    }
+    *messageStream << entry.warnings.constData();
+    for (const TranslatorMessage &msg : std::as_const(entry.messages))
+        fetchedTor.extend(msg, cd);
+}
+
+using SourceLoader = bool (*)(Translator &, const QString &, ConversionData &);
+
+// The parsers keep their state in globals, so the files of one language
+// must not be extracted by several threads at once.
+enum SourceLanguage { JavaLanguage, UiLanguage, QmlLanguage, PythonLanguage, NumSourceLanguages };
+
+static SourceLoader sourceLoader(const QString &sourceFile, SourceLanguage *language)
+{
+    if (sourceFile.endsWith(QLatin1String(".java"), Qt::CaseInsensitive)) {
+        *language = JavaLanguage;
+        return loadJava;
+    }
+    if (sourceFile.endsWith(QLatin1String(".ui"), Qt::CaseInsensitive)
+        || sourceFile.endsWith(QLatin1String(".jui"), Qt::CaseInsensitive)) {
+        *language = UiLanguage;
+        return loadUI;
+    }
+#ifndef QT_NO_QML
+    if (sourceFile.endsWith(QLatin1String(".js"), Qt::CaseInsensitive)
+        || sourceFile.endsWith(QLatin1String(".qs"), Qt::CaseInsensitive)) {
+        *language = QmlLanguage;
+        return loadQScript;
+    }
+    if (sourceFile.endsWith(QLatin1String(".mjs"), Qt::CaseInsensitive)) {
+        *language = QmlLanguage;
+        return loadJSModule;
+    }
+    if (sourceFile.endsWith(QLatin1String(".qml"), Qt::CaseInsensitive)) {
+        *language = QmlLanguage;
+        return loadQml;
+    }
+#endif // QT_NO_QML
+    if (sourceFile.endsWith(u".py", Qt::CaseInsensitive)) {
+        *language = PythonLanguage;
+        return loadPython;
+    }
+    return nullptr;
+}
+
+// A file that is not C++ and whose messages are merged after all of them are
+// extracted. Translation files have no loader and are read while merging.
+struct ExtractedSource
+{
+    QString fileName;
+    SourceLoader load = nullptr;
+    SourceLanguage language = JavaLanguage;
+    // The messages as they were extracted, with one location each.
+    QList<TranslatorMessage> messages;
+    QStringList errors;
+    std::string warnings;
+};
+
+// Extracts the messages of the sources with up to maxThreads threads. All files
+// of one language are handled by the same thread.
+static std::vector<std::thread> startExtraction(std::vector<ExtractedSource> &sources,
+                                                const ConversionData &cd, int maxThreads)
+{
+    bool languages[NumSourceLanguages] = {};
+    for (const ExtractedSource &source : sources) {
+        if (source.load)
+            languages[source.language] = true;
+    }
+    maxThreads = qMax(1, maxThreads);
+    int workerOf[NumSourceLanguages] = {};
+    int languageCount = 0;
+    for (int language = 0; language < NumSourceLanguages; ++language) {
+        if (languages[language])
+            workerOf[language] = languageCount++ % maxThreads;
+    }
+    const int workerCount = qMin(languageCount, maxThreads);
+
+    // Set up what is shared, so that the threads only read it.
+    trFunctionAliasManager.nameToTrFunctionMap();
+
+    std::vector<std::thread> workers;
+    for (int worker = 0; worker < workerCount; ++worker) {
+        workers.emplace_back([&sources, workerOf, worker, workerCd = cd]() mutable {
+            TranslatorMessage::InternScope internScope;
+            workerCd.clearErrors();
+            for (ExtractedSource &source : sources) {
+                if (!source.load || workerOf[source.language] != worker)
+                    continue;
+                Translator tor;
+                tor.setExtendLog(&source.messages);
+                std::ostringstream warnings;
+                messageStream = &warnings;
+                loadSource(source.load, tor, source.fileName, workerCd);
+                messageStream = &std::cerr;
+                source.warnings = warnings.str();
+                source.errors = workerCd.errors();
+                workerCd.clearErrors();
             }
-            return true;
+        });
+    }
+    return workers;
+}
+
+// Merges the extracted messages in the order of the files, in the same way as
+// extracting them one file after the other.
+static void finishExtraction(Translator &fetchedTor, std::vector<ExtractedSource> &sources,
+                             std::vector<std::thread> &workers, ConversionData &cd)
+{
+    for (std::thread &worker : workers)
+        worker.join();
+    workers.clear();
+
+    for (const ExtractedSource &source : sources) {
+        if (!source.load) {
+            processTs(fetchedTor, source.fileName, cd);
+            continue;
         }
+        std::cerr << source.warnings;
+        for (const QString &error : source.errors)
+            cd.appendError(error);
+        for (const TranslatorMessage &msg : source.messages)
+            fetchedTor.extend(msg, cd);
     }
-    return false;
+    sources.clear();
 }
 
 static void processSources(Translator &fetchedTor, const QStringList &sourceFiles,
                            ConversionData &cd, UpdateOptions options, bool *fail)
 {
+    if (ExtractionCache *cache = ExtractionCache::the())
+        cache->setOptions(cd);
+
+    // With several threads, the files in other languages are extracted while
+    // the C++ files are parsed.
+    const bool parallel = threadCount > 1;
+    std::vector<ExtractedSource> extracted;
+
 #ifdef QT_NO_QML
     bool requireQmlSupport = false;
 #endif
     QStringList sourceFilesCpp;
     for (const auto &sourceFile : sourceFiles) {
-        if (sourceFile.endsWith(QLatin1String(".java"), Qt::CaseInsensitive))
-            loadJava(fetchedTor, sourceFile, cd);
-        else if (sourceFile.endsWith(QLatin1String(".ui"), Qt::CaseInsensitive)
-                 || sourceFile.endsWith(QLatin1String(".jui"), Qt::CaseInsensitive))
-            loadUI(fetchedTor, sourceFile, cd);
-#ifndef QT_NO_QML
-        else if (sourceFile.endsWith(QLatin1String(".js"), Qt::CaseInsensitive)
-                 || sourceFile.endsWith(QLatin1String(".qs"), Qt::CaseInsensitive)) {
-            loadQScript(fetchedTor, sourceFile, cd);
-        } else if (sourceFile.endsWith(QLatin1String(".mjs"), Qt::CaseInsensitive)) {
-            loadJSModule(fetchedTor, sourceFile, cd);
-        } else if (sourceFile.endsWith(QLatin1String(".qml"), Qt::CaseInsensitive))
-            loadQml(fetchedTor, sourceFile, cd);
-#else
+        SourceLanguage language = JavaLanguage;
+        if (SourceLoader load = sourceLoader(sourceFile, &language)) {
+            if (parallel)
+                extracted.push_back({ sourceFile, load, language, {}, {} });
+            else
+                loadSource(load, fetchedTor, sourceFile, cd);
+        }
+#ifdef QT_NO_QML
         else if (sourceFile.endsWith(QLatin1String(".qml"), Qt::CaseInsensitive)
                  || sourceFile.endsWith(QLatin1String(".js"), Qt::CaseInsensitive)
                  || sourceFile.endsWith(QLatin1String(".mjs"), Qt::CaseInsensitive)
                  || sourceFile.endsWith(QLatin1String(".qs"), Qt::CaseInsensitive))
             requireQmlSupport = true;
 #endif // QT_NO_QML
-        else if (sourceFile.endsWith(u".py", Qt::CaseInsensitive))
-            loadPython(fetchedTor, sourceFile, cd);
-        else if (!processTs(fetchedTor, sourceFile, cd))
+        else if (!parallel) {
+            if (!processTs(fetchedTor, sourceFile, cd))
+                sourceFilesCpp << sourceFile;
+        } else if (!translationFormat(sourceFile).isEmpty()) {
+            extracted.push_back({ sourceFile, nullptr, JavaLanguage, {}, {} });
+        } else {
             sourceFilesCpp << sourceFile;
+        }
     }
 
+    // The extraction threads count towards the threads of the C++ parser.
+    std::vector<std::thread> workers = startExtraction(extracted, cd, threadCount - 1);
+
 #ifdef QT_NO_QML
     if (requireQmlSupport) {
         printWarning(options, u"missing qml/javascript support\n"_s,
                      u"Some files have been ignored.\n"_s);
-        if (options & Werror)
+        if (options & Werror) {
+            finishExtraction(fetchedTor, extracted, workers, cd);
             return;
+        }
     }
 #else
     Q_UNUSED(options)
 #endif
 
+    if (workers.empty())
+        finishExtraction(fetchedTor, extracted, workers, cd);
+
+    // The C++ messages and warnings go after all others, so they are kept
+    // apart while the other files are still being extracted.
+    const bool separateCpp = !workers.empty();
+    Translator cppTor;
+    QList<TranslatorMessage> cppMessages;
+    ConversionData cppCd;
+    std::ostringstream cppWarnings;
+    if (separateCpp) {
+        cppCd = cd;
+        cppCd.clearErrors();
+        cppTor.setExtendLog(&cppMessages);
+        messageStream = &cppWarnings;
+    }
+    Translator &cppTarget = separateCpp ? cppTor : fetchedTor;
+    ConversionData &cppTargetCd = separateCpp ? cppCd : cd;
+
     if (useClangToParseCpp) {
 #if QT_CONFIG(clangcpp)
-        ClangCppParser::loadCPP(fetchedTor, sourceFilesCpp, cd, fail);
+        ClangCppParser::loadCPP(cppTarget, sourceFilesCpp, cppTargetCd, fail);
 #else
         *fail = true;
         printErr(QStringLiteral("lupdate error: lupdate was built without clang support."));
 #endif
     }
     else
-        loadCPP(fetchedTor, sourceFilesCpp, cd);
+        loadCPP(cppTarget, sourceFilesCpp, cppTargetCd,
+                qMax(1, threadCount - int(workers.size())));
+
+    if (separateCpp) {
+        messageStream = &std::cerr;
+        finishExtraction(fetchedTor, extracted, workers, cd);
+        std::cerr << cppWarnings.str();
+        for (const QString &error : cppCd.errors())
+            cd.appendError(error);
+        for (const TranslatorMessage &msg : std::as_const(cppMessages))
+            fetchedTor.extend(msg, cd);
+    }
 
     if (!cd.error().isEmpty())
         printErr(cd.error());
@@ -789,8 +1156,11 @@ int main(int argc, char **argv)
     QStringList args = app.arguments();
     QStringList tsFileNames;
     QStringList proFiles;
+    QHash<QString, QString> proOutDirs;
+    int proDebug = 0;
     QString projectDescriptionFile;
     QString outDir = QDir::currentPath();
+    QString cacheDir;
     QMultiHash<QString, QString> allCSources;
     QSet<QString> projectRoots;
     QStringList sourceFiles;
@@ -834,6 +1204,7 @@ int main(int argc, char **argv)
             options &= ~Verbose;
             continue;
         } else if (arg == QLatin1String("-pro-debug")) {
+            proDebug++;
             continue;
         } else if (arg == QLatin1String("-project")) {
             ++i;
@@ -952,6 +1323,7 @@ int main(int argc, char **argv)
             }
             QString file = QDir::cleanPath(QFileInfo(args[i]).absoluteFilePath());
             proFiles += file;
+            proOutDirs[file] = outDir;
             numFiles++;
             continue;
         } else if (arg == QLatin1String("-pro-out")) {
@@ -962,6 +1334,29 @@ int main(int argc, char **argv)
             }
             outDir = QDir::cleanPath(QFileInfo(args[i]).absoluteFilePath());
             continue;
+        } else if (arg == QLatin1String("-cache-dir")) {
+            ++i;
+            if (i == argc) {
+                printErr(u"The -cache-dir option should be followed by a directory name.\n"_s);
+                return 1;
+            }
+            cacheDir = QDir::cleanPath(QFileInfo(args[i]).absoluteFilePath());
+            continue;
+        } else if (arg == QLatin1String("-j")) {
+            ++i;
+            if (i == argc) {
+                printErr(u"The -j option should be followed by a number of threads.\n"_s);
+                return 1;
+            }
+            bool ok = false;
+            threadCount = args[i].toInt(&ok);
+            if (!ok || threadCount < 0) {
+                printErr(u"Invalid number of threads passed to -j.\n"_s);
+                return 1;
+            }
+            if (threadCount == 0)
+                threadCount = qMax(1, int(std::thread::hardware_concurrency()));
+            continue;
         } else if (arg.startsWith(QLatin1String("-I"))) {
             if (arg.size() == 2) {
                 ++i;
@@ -1060,6 +1455,7 @@ int main(int argc, char **argv)
                 if (isProOrPriFile(file)) {
                     QString cleanFile = QDir::cleanPath(fi.absoluteFilePath());
                     proFiles << cleanFile;
+                    proOutDirs[cleanFile] = outDir;
                 } else if (fi.isDir()) {
                     if (options & Verbose)
                         printOut(QStringLiteral("Scanning directory '%1'...\n").arg(file));
@@ -1136,29 +1532,46 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    QString errorString;
-    if (!proFiles.isEmpty()) {
-        runInternalQtTool(u"lupdate-pro"_s, app.arguments().mid(1));
-        return 0;
-    }
+    if (!cacheDir.isEmpty())
+        ExtractionCache::create(cacheDir);
 
+    QString errorString;
     Projects projectDescription;
-    if (!projectDescriptionFile.isEmpty()) {
-        projectDescription = readProjectDescription(projectDescriptionFile, &errorString);
-        if (!errorString.isEmpty()) {
-            printErr(QStringLiteral("lupdate error: %1\n").arg(errorString));
+    if (!proFiles.isEmpty()) {
+        if (!projectDescriptionFile.isEmpty()) {
+            printErr(u"lupdate error: Do not specify .pro files if -project is given.\n"_s);
             return 1;
         }
-        if (projectDescription.empty()) {
+        // Evaluate the qmake projects in this process instead of passing them
+        // through lupdate-pro and lprodump.
+        ProjectDumper dumper;
+        dumper.setVerbose(options & Verbose);
+        dumper.setDebugLevel(proDebug);
+        dumper.setThreadCount(threadCount);
+        bool proFail = false;
+        const QJsonArray rawProjects = dumper.dump(proFiles, proOutDirs, &proFail);
+        if (proFail)
+            return 1;
+        projectDescription = readProjectDescription(rawProjects, &errorString);
+    } else if (!projectDescriptionFile.isEmpty()) {
+        projectDescription = readProjectDescription(projectDescriptionFile, &errorString);
+        if (errorString.isEmpty() && projectDescription.empty()) {
             printErr(QStringLiteral("lupdate error:"
                             " Could not find project descriptions in %1.\n")
                      .arg(projectDescriptionFile));
             return 1;
         }
-        removeExcludedSources(projectDescription);
-        for (Project &project : projectDescription)
-            expandQrcFiles(project);
     }
+    if (!errorString.isEmpty()) {
+        printErr(QStringLiteral("lupdate error: %1\n").arg(errorString));
+        return 1;
+    }
+    removeExcludedSources(projectDescription);
+    for (Project &project : projectDescription)
+        expandQrcFiles(project);
+
+    // Share the contexts and file names of the messages of all files and projects.
+    TranslatorMessage::InternScope internScope;
 
     if (projectDescription.empty()) {
         if (tsFileNames.isEmpty()) {
@@ -1204,5 +1617,6 @@ int main(int argc, char **argv)
                                              &fail);
         }
     }
+    ExtractionCache::destroy();
     return fail ? 1 : 0;
 }
@@ -56,10 +56,9 @@ int applySameTextHeuristic(Translator &tor)
 
     for (int i = 0; i < tor.messageCount(); ++i) {
         if (untranslated[i]) {
-            TranslatorMessage &msg = tor.message(i);
-            const auto t = translated.constFind(msg.sourceText());
+            const auto t = translated.constFind(tor.message(i).sourceText());
             if (t != translated.constEnd()) {
-                msg.setTranslations(*t);
+                tor.setTranslations(i, *t);
                 ++inserted;
             }
         }
@@ -253,9 +252,9 @@ Translator merge(
                 continue;
             int mvi = outTor.find(mv);
             if (mvi >= 0) {
-                TranslatorMessage &tm = outTor.message(mvi);
+                const TranslatorMessage &tm = outTor.message(mvi);
                 if (tm.type() != TranslatorMessage::Finished && !tm.isTranslated()) {
-                    tm.setTranslations(mv.translations());
+                    outTor.setTranslations(mvi, mv.translations());
                     --neww;
                     ++known;
                 }
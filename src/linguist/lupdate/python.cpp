@@ -15,6 +15,7 @@
 #include <cerrno>
 #include <cstdio>
 #include <cstring>
+#include <ostream>
 
 QT_BEGIN_NAMESPACE
 
@@ -268,8 +269,8 @@ static Token parseString(StringType stringType = StringType::NoString)
     if (yyCh != quoteChar) {
         printf("%c\n", yyCh);
 
-        qWarning("%s:%d: Unterminated string",
-                 qPrintable(yyFileName), yyLineNo);
+        *messageStream << qPrintable(yyFileName) << ':' << yyLineNo
+                       << ": Unterminated string\n";
     }
 
     if (yyCh == EOF)
@@ -741,8 +742,8 @@ static void parse(Translator &tor, ConversionData &cd,
     }
 
     if (yyParenDepth != 0) {
-        qWarning("%s: Unbalanced parentheses in Python code",
-                 qPrintable(yyFileName));
+        *messageStream << qPrintable(yyFileName)
+                       << ": Unbalanced parentheses in Python code\n";
     }
 }
 
@@ -202,12 +202,12 @@ protected:
 private:
     std::ostream &yyMsg(int line)
     {
-        return std::cerr << qPrintable(m_fileName) << ':' << line << ": ";
+        return *messageStream << qPrintable(m_fileName) << ':' << line << ": ";
     }
 
     void throwRecursionDepthError() final
     {
-        std::cerr << qPrintable(m_fileName) << ": "
+        *messageStream << qPrintable(m_fileName) << ": "
                   << "Maximum statement or expression depth exceeded";
     }
 
@@ -241,6 +241,14 @@ Projects readProjectDescription(const QString &filePath, QString *errorString)
     const QJsonArray rawProjects = readRawProjectDescription(filePath, errorString);
     if (!errorString->isEmpty())
         return {};
+    return readProjectDescription(rawProjects, errorString);
+}
+
+// Converts a description that was generated in the same process, for example
+// by ProjectDumper, without writing it to a file and parsing it again.
+Projects readProjectDescription(const QJsonArray &rawProjects, QString *errorString)
+{
+    errorString->clear();
     ProjectConverter converter(errorString);
     Projects result = converter.convertProjects(rawProjects);
     if (!errorString->isEmpty())
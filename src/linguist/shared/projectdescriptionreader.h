@@ -4,6 +4,7 @@
 #ifndef PROJECTDESCRIPTIONREADER_H
 #define PROJECTDESCRIPTIONREADER_H
 
+#include <QtCore/qjsonarray.h>
 #include <QtCore/qregularexpression.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qstringlist.h>
@@ -29,5 +30,6 @@ struct Project
 };
 
 Projects readProjectDescription(const QString &filePath, QString *errorString);
+Projects readProjectDescription(const QJsonArray &rawProjects, QString *errorString);
 
 #endif // PROJECTDESCRIPTIONREADER_H
@@ -0,0 +1,444 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "projectdumper.h"
+
+#include <profileevaluator.h>
+#include <qmakeparser.h>
+#include <qmakevfs.h>
+#include <qrcreader.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QDirIterator>
+#include <QtCore/QFileInfo>
+#include <QtCore/QLibraryInfo>
+#include <QtCore/QRegularExpression>
+
+#include <QtCore/QJsonObject>
+
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Collects the messages of the project that the current thread evaluates.
+static thread_local QString *messageBuffer = nullptr;
+
+static void printErr(const QString &out)
+{
+    if (messageBuffer)
+        messageBuffer->append(out);
+    else
+        std::cerr << qPrintable(out);
+}
+
+static QString errorPrefix()
+{
+    return QCoreApplication::applicationName() + QLatin1String(" error: ");
+}
+
+static QJsonValue toJsonValue(const QJsonValue &v)
+{
+    return v;
+}
+
+static QJsonValue toJsonValue(const QString &s)
+{
+    return QJsonValue(s);
+}
+
+static QJsonValue toJsonValue(const QStringList &lst)
+{
+    return QJsonArray::fromStringList(lst);
+}
+
+template <class T>
+void setValue(QJsonObject &obj, const char *key, T value)
+{
+    obj[QLatin1String(key)] = toJsonValue(value);
+}
+
+static void print(const QString &fileName, int lineNo, const QString &msg)
+{
+    if (lineNo > 0)
+        printErr(QString::fromLatin1("WARNING: %1:%2: %3\n").arg(fileName, QString::number(lineNo), msg));
+    else if (lineNo)
+        printErr(QString::fromLatin1("WARNING: %1: %2\n").arg(fileName, msg));
+    else
+        printErr(QString::fromLatin1("WARNING: %1\n").arg(msg));
+}
+
+class EvalHandler : public QMakeHandler {
+public:
+    void message(int type, const QString &msg, const QString &fileName, int lineNo) override
+    {
+        if (verbose && !(type & CumulativeEvalMessage) && (type & CategoryMask) == ErrorMessage)
+            print(fileName, lineNo, msg);
+    }
+
+    void fileMessage(int type, const QString &msg) override
+    {
+        if (verbose && !(type & CumulativeEvalMessage) && (type & CategoryMask) == ErrorMessage) {
+            // "Downgrade" errors, as we don't really care for them
+            printErr(QLatin1String("WARNING: ") + msg + QLatin1Char('\n'));
+        }
+    }
+
+    void aboutToEval(ProFile *, ProFile *, EvalFileType) override {}
+    void doneWithEval(ProFile *) override {}
+
+    bool verbose = true;
+};
+
+static QStringList getResources(const QString &resourceFile, QMakeVfs *vfs)
+{
+    Q_ASSERT(vfs);
+    if (!vfs->exists(resourceFile, QMakeVfs::VfsCumulative))
+        return QStringList();
+    QString content;
+    QString errStr;
+    if (vfs->readFile(vfs->idForFileName(resourceFile, QMakeVfs::VfsCumulative),
+                      &content, &errStr) != QMakeVfs::ReadOk) {
+        printErr(errorPrefix() + QStringLiteral("Cannot read %1: %2\n").arg(resourceFile, errStr));
+        return QStringList();
+    }
+    const ReadQrcResult rqr = readQrcFile(resourceFile, content);
+    if (rqr.hasError()) {
+        printErr(errorPrefix() + QStringLiteral("%1:%2: %3\n")
+                 .arg(resourceFile, QString::number(rqr.line), rqr.errorString));
+    }
+    return rqr.files;
+}
+
+static QStringList getSources(const char *var, const char *vvar, const QStringList &baseVPaths,
+                              const QString &projectDir, const ProFileEvaluator &visitor)
+{
+    QStringList vPaths = visitor.absolutePathValues(QLatin1String(vvar), projectDir);
+    vPaths += baseVPaths;
+    vPaths.removeDuplicates();
+    return visitor.absoluteFileValues(QLatin1String(var), projectDir, vPaths, 0);
+}
+
+static QStringList getSources(const ProFileEvaluator &visitor, const QString &projectDir,
+                              QMakeVfs *vfs)
+{
+    QStringList baseVPaths;
+    baseVPaths += visitor.absolutePathValues(QLatin1String("VPATH"), projectDir);
+    baseVPaths << projectDir; // QMAKE_ABSOLUTE_SOURCE_PATH
+    baseVPaths.removeDuplicates();
+
+    QStringList sourceFiles;
+
+    // app/lib template
+    sourceFiles += getSources("SOURCES", "VPATH_SOURCES", baseVPaths, projectDir, visitor);
+    sourceFiles += getSources("HEADERS", "VPATH_HEADERS", baseVPaths, projectDir, visitor);
+
+    sourceFiles += getSources("FORMS", "VPATH_FORMS", baseVPaths, projectDir, visitor);
+
+    const QStringList resourceFiles = getSources("RESOURCES", "VPATH_RESOURCES", baseVPaths, projectDir, visitor);
+    for (const QString &resource : resourceFiles)
+        sourceFiles += getResources(resource, vfs);
+
+    QStringList installs = visitor.values(QLatin1String("INSTALLS"))
+                         + visitor.values(QLatin1String("DEPLOYMENT"));
+    installs.removeDuplicates();
+    QDir baseDir(projectDir);
+    for (const QString &inst : std::as_const(installs)) {
+        for (const QString &file : visitor.values(inst + QLatin1String(".files"))) {
+            QFileInfo info(file);
+            if (!info.isAbsolute())
+                info.setFile(baseDir.absoluteFilePath(file));
+            QStringList nameFilter;
+            QString searchPath;
+            if (info.isDir()) {
+                nameFilter << QLatin1String("*");
+                searchPath = info.filePath();
+            } else {
+                nameFilter << info.fileName();
+                searchPath = info.path();
+            }
+
+            QDirIterator iterator(searchPath, nameFilter,
+                                  QDir::Files | QDir::NoDotAndDotDot | QDir::NoSymLinks,
+                                  QDirIterator::Subdirectories);
+            while (iterator.hasNext()) {
+                iterator.next();
+                QFileInfo cfi = iterator.fileInfo();
+                if (isSupportedExtension(cfi.suffix()))
+                    sourceFiles << cfi.filePath();
+            }
+        }
+    }
+
+    sourceFiles.removeDuplicates();
+    sourceFiles.sort();
+    return sourceFiles;
+}
+
+static QStringList getExcludes(const ProFileEvaluator &visitor, const QString &projectDirPath)
+{
+    const QStringList trExcludes = visitor.values(QLatin1String("TR_EXCLUDE"));
+    QStringList excludes;
+    excludes.reserve(trExcludes.size());
+    const QDir projectDir(projectDirPath);
+    for (const QString &ex : trExcludes)
+        excludes << QDir::cleanPath(projectDir.absoluteFilePath(ex));
+    return excludes;
+}
+
+static void excludeProjects(const ProFileEvaluator &visitor, QStringList *subProjects)
+{
+    for (const QString &ex : visitor.values(QLatin1String("TR_EXCLUDE"))) {
+        QRegularExpression rx(QRegularExpression::wildcardToRegularExpression(ex));
+        for (auto it = subProjects->begin(); it != subProjects->end(); ) {
+            if (rx.match(*it).hasMatch())
+                it = subProjects->erase(it);
+            else
+                ++it;
+        }
+    }
+}
+
+static QJsonObject processProject(const QString &proFile, const QStringList &translationsVariables,
+                                  QMakeVfs *vfs, ProFileEvaluator &visitor,
+                                  QStringList *subProFiles)
+{
+    QJsonObject result;
+    QStringList tmp = visitor.values(QLatin1String("CODECFORSRC"));
+    if (!tmp.isEmpty())
+        result[QStringLiteral("codec")] = tmp.last();
+    QString proPath = QFileInfo(proFile).path();
+    if (visitor.templateType() == ProFileEvaluator::TT_Subdirs) {
+        QStringList subProjects = visitor.values(QLatin1String("SUBDIRS"));
+        excludeProjects(visitor, &subProjects);
+        QDir proDir(proPath);
+        for (const QString &subdir : std::as_const(subProjects)) {
+            QString realdir = visitor.value(subdir + QLatin1String(".subdir"));
+            if (realdir.isEmpty())
+                realdir = visitor.value(subdir + QLatin1String(".file"));
+            if (realdir.isEmpty())
+                realdir = subdir;
+            QString subPro = QDir::cleanPath(proDir.absoluteFilePath(realdir));
+            QFileInfo subInfo(subPro);
+            if (subInfo.isDir()) {
+                *subProFiles << (subPro + QLatin1Char('/')
+                                 + subInfo.fileName() + QLatin1String(".pro"));
+            } else {
+                *subProFiles << subPro;
+            }
+        }
+    } else {
+        const QStringList sourceFiles = getSources(visitor, proPath, vfs);
+        setValue(result, "includePaths",
+                 visitor.absolutePathValues(QLatin1String("INCLUDEPATH"), proPath));
+        setValue(result, "excluded", getExcludes(visitor, proPath));
+        setValue(result, "sources", sourceFiles);
+    }
+
+    setValue(result, "projectFile", proFile);
+    QStringList tsFiles;
+    for (const QString &varName : translationsVariables) {
+        if (!visitor.contains(varName))
+            continue;
+        QDir proDir(QFileInfo(proFile).path());
+        const QStringList translations = visitor.values(varName);
+        for (const QString &tsFile : translations)
+            tsFiles << proDir.filePath(tsFile);
+    }
+    if (!tsFiles.isEmpty())
+        setValue(result, "translations", tsFiles);
+    if (visitor.contains(QLatin1String("LUPDATE_COMPILE_COMMANDS_PATH"))) {
+        const QStringList thepathjson = visitor.values(
+            QLatin1String("LUPDATE_COMPILE_COMMANDS_PATH"));
+        setValue(result, "compileCommands", thepathjson.value(0));
+    }
+    return result;
+}
+
+/*
+ * Evaluates a project and all of its subprojects, using up to the given
+ * number of threads. Each thread takes the next project that is waiting to be
+ * evaluated, and queues its subprojects in turn. The parse cache, the virtual
+ * file system, and the base environment of the globals are shared, which is
+ * why the evaluator sources are built with PROEVALUATOR_THREAD_SAFE and
+ * PROPARSER_THREAD_SAFE.
+ *
+ * The messages of each project are collected and printed in the order in
+ * which evaluating the projects one by one would print them, and the
+ * subprojects keep the order of SUBDIRS, so the output does not depend on the
+ * number of threads.
+ */
+class ProjectTreeEvaluator
+{
+public:
+    ProjectTreeEvaluator(const QStringList &translationsVariables, ProFileGlobals *option,
+                         QMakeVfs *vfs, QMakeHandler *handler,
+                         const std::vector<std::unique_ptr<QMakeParser>> &parsers)
+        : m_translationsVariables(translationsVariables),
+          m_option(option),
+          m_vfs(vfs),
+          m_handler(handler),
+          m_parsers(parsers)
+    {
+    }
+
+    bool evaluate(const QString &proFile, QJsonArray *result);
+
+private:
+    struct Node
+    {
+        QString proFile;
+        bool topLevel = false;
+        bool ok = false;
+        QJsonObject description;
+        std::vector<size_t> subProjects;
+        QString messages;
+    };
+
+    void work(QMakeParser *parser);
+    void evaluateNode(Node &node, QMakeParser *parser, QStringList *subProFiles);
+    void collect(const Node &node, QJsonArray *result) const;
+
+    const QStringList &m_translationsVariables;
+    ProFileGlobals *m_option;
+    QMakeVfs *m_vfs;
+    QMakeHandler *m_handler;
+    const std::vector<std::unique_ptr<QMakeParser>> &m_parsers;
+
+    std::deque<Node> m_nodes; // not invalidated by appending
+    std::deque<size_t> m_queue;
+    size_t m_pending = 0; // queued or being evaluated
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+};
+
+bool ProjectTreeEvaluator::evaluate(const QString &proFile, QJsonArray *result)
+{
+    m_nodes.clear();
+    m_nodes.push_back(Node{ proFile, true });
+    m_queue.push_back(0);
+    m_pending = 1;
+
+    if (m_parsers.size() == 1) {
+        work(m_parsers.front().get());
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(m_parsers.size());
+        for (const auto &parser : m_parsers)
+            threads.emplace_back(&ProjectTreeEvaluator::work, this, parser.get());
+        for (std::thread &thread : threads)
+            thread.join();
+    }
+
+    collect(m_nodes.front(), result);
+    return m_nodes.front().ok;
+}
+
+void ProjectTreeEvaluator::work(QMakeParser *parser)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_changed.wait(lock, [this] { return !m_queue.empty() || m_pending == 0; });
+        if (m_queue.empty())
+            return;
+        Node &node = m_nodes[m_queue.front()];
+        m_queue.pop_front();
+        lock.unlock();
+
+        QStringList subProFiles;
+        evaluateNode(node, parser, &subProFiles);
+
+        lock.lock();
+        for (const QString &subProFile : std::as_const(subProFiles)) {
+            node.subProjects.push_back(m_nodes.size());
+            m_queue.push_back(m_nodes.size());
+            m_nodes.push_back(Node{ subProFile });
+            ++m_pending;
+        }
+        --m_pending;
+        m_changed.notify_all();
+    }
+}
+
+void ProjectTreeEvaluator::evaluateNode(Node &node, QMakeParser *parser,
+                                        QStringList *subProFiles)
+{
+    messageBuffer = &node.messages;
+    ProFile *pro;
+    if (!(pro = parser->parsedProFile(node.proFile, node.topLevel ? QMakeParser::ParseReportMissing
+                                                                  : QMakeParser::ParseDefault))) {
+        messageBuffer = nullptr;
+        return;
+    }
+    ProFileEvaluator visitor(m_option, parser, m_vfs, m_handler);
+    visitor.setCumulative(true);
+    visitor.setOutputDir(m_option->shadowedPath(pro->directoryName()));
+    if (visitor.accept(pro)) {
+        node.description = processProject(node.proFile, m_translationsVariables, m_vfs, visitor,
+                                          subProFiles);
+        node.ok = true;
+    }
+    pro->deref();
+    messageBuffer = nullptr;
+}
+
+void ProjectTreeEvaluator::collect(const Node &node, QJsonArray *result) const
+{
+    if (!node.messages.isEmpty())
+        std::cerr << qPrintable(node.messages);
+    QJsonArray subResults;
+    for (size_t subProject : node.subProjects)
+        collect(m_nodes[subProject], &subResults);
+    if (!node.ok)
+        return;
+    QJsonObject description = node.description;
+    if (!subResults.isEmpty())
+        setValue(description, "subProjects", subResults);
+    result->append(description);
+}
+
+/*
+ * Evaluates proFiles and returns their descriptions, including those of their
+ * subprojects. Sets \a fail if one of proFiles cannot be read or evaluated.
+ */
+QJsonArray ProjectDumper::dump(const QStringList &proFiles,
+                               const QHash<QString, QString> &outDirMap, bool *fail) const
+{
+    ProFileEvaluator::initialize();
+    QMakeParser::initialize();
+
+    EvalHandler evalHandler;
+    evalHandler.verbose = m_verbose;
+
+    ProFileGlobals option;
+    option.qmake_abslocation = QString::fromLocal8Bit(qgetenv("QMAKE"));
+    if (option.qmake_abslocation.isEmpty()) {
+        option.qmake_abslocation = QLibraryInfo::path(QLibraryInfo::BinariesPath)
+            + QLatin1String("/qmake");
+    }
+    option.debugLevel = m_debugLevel;
+    option.initProperties();
+    option.setCommandLineArguments(QDir::currentPath(),
+                                   QStringList() << QLatin1String("CONFIG+=lupdate_run"));
+    QMakeVfs vfs;
+    ProFileCache cache;
+    // The base environments in the globals refer to the parser of the thread
+    // that created them, so the parsers live as long as the globals are used.
+    std::vector<std::unique_ptr<QMakeParser>> parsers;
+    for (int i = 0; i < qMax(1, m_threadCount); ++i)
+        parsers.push_back(std::make_unique<QMakeParser>(&cache, &vfs, &evalHandler));
+
+    ProjectTreeEvaluator evaluator(m_translationsVariables, &option, &vfs, &evalHandler, parsers);
+    QJsonArray result;
+    for (const QString &proFile : proFiles) {
+        if (!outDirMap.isEmpty())
+            option.setDirectories(QFileInfo(proFile).path(), outDirMap.value(proFile));
+        if (!evaluator.evaluate(proFile, &result))
+            *fail = true;
+    }
+    return result;
+}
@@ -0,0 +1,38 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef PROJECTDUMPER_H
+#define PROJECTDUMPER_H
+
+#include <QtCore/qhash.h>
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+
+// Evaluates qmake project files and describes them in the format that
+// readProjectDescription() converts to Projects.
+class ProjectDumper
+{
+public:
+    void setVerbose(bool verbose) { m_verbose = verbose; }
+    void setDebugLevel(int level) { m_debugLevel = level; }
+    // Subprojects are evaluated with up to this many threads.
+    void setThreadCount(int count) { m_threadCount = count; }
+    void setTranslationsVariables(const QStringList &variables)
+    {
+        m_translationsVariables = variables;
+    }
+
+    // outDirMap maps each of the (clean, absolute) proFiles to its virtual
+    // output directory.
+    QJsonArray dump(const QStringList &proFiles, const QHash<QString, QString> &outDirMap,
+                    bool *fail) const;
+
+private:
+    bool m_verbose = true;
+    int m_debugLevel = 0;
+    int m_threadCount = 1;
+    QStringList m_translationsVariables = { QStringLiteral("TRANSLATIONS") };
+};
+
+#endif // PROJECTDUMPER_H
@@ -1,6 +1,7 @@
 // Copyright (C) 2016 The Qt Company Ltd.
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
 
+#include "qmview.h"
 #include "translator.h"
 
 #ifndef QT_BOOTSTRAPPED
@@ -14,6 +15,7 @@
 #include <QtCore/QMap>
 #include <QtCore/QString>
 #include <QtCore/QStringDecoder>
+#include <QtCore/QtEndian>
 
 QT_BEGIN_NAMESPACE
 
@@ -425,18 +427,39 @@ static quint32 read32(const uchar *data)
     return (data[0] << 24) | (data[1] << 16) | (data[2] << 8) | (data[3]);
 }
 
-static void fromBytes(const char *str, int len, QString *out, bool *utf8Fail)
+// Sets *utf8Fail if bytes is not valid UTF-8, but never clears it, so that
+// an error in any string of the file is reported.
+static void fromBytes(QByteArrayView bytes, QString *out, bool *utf8Fail)
 {
     QStringDecoder toUnicode(QStringDecoder::Utf8, QStringDecoder::Flag::Stateless);
-    *out = toUnicode(QByteArrayView(str, len));
-    *utf8Fail = toUnicode.hasError();
+    *out = toUnicode(bytes);
+    *utf8Fail |= toUnicode.hasError();
 }
 
-bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
+QmView::~QmView()
 {
-    QByteArray ba = dev.readAll();
-    const uchar *data = (uchar*)ba.data();
-    int len = ba.size();
+    if (m_mapped)
+        m_mappedFile->unmap(m_mapped);
+}
+
+bool QmView::open(QIODevice &dev, ConversionData &cd)
+{
+    const uchar *data = nullptr;
+    qint64 len = 0;
+    QFile *file = qobject_cast<QFile *>(&dev);
+    if (file && !file->isSequential()) {
+        len = file->size() - file->pos();
+        m_mapped = file->map(file->pos(), len);
+        if (m_mapped) {
+            m_mappedFile = file;
+            data = m_mapped;
+        }
+    }
+    if (!data) {
+        m_data = dev.readAll();
+        data = reinterpret_cast<const uchar *>(m_data.constData());
+        len = m_data.size();
+    }
     if (len < MagicLength || memcmp(data, magic, MagicLength) != 0) {
         cd.appendError(QLatin1String("QM-Format error: magic marker missing"));
         return false;
@@ -444,57 +467,143 @@ bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
 
     enum { Contexts = 0x2f, Hashes = 0x42, Messages = 0x69, NumerusRules = 0x88, Dependencies = 0x96, Language = 0xa7 };
 
-    // for squeezed but non-file data, this is what needs to be deleted
-    const uchar *messageArray = nullptr;
-    const uchar *offsetArray = nullptr;
-    uint offsetLength = 0;
-
-    bool ok = true;
-    bool utf8Fail = false;
     const uchar *end = data + len;
-
     data += MagicLength;
 
     while (data < end - 4) {
         quint8 tag = read8(data++);
         quint32 blockLen = read32(data);
-        //qDebug() << "TAG:" << tag <<  "BLOCKLEN:" << blockLen;
         data += 4;
         if (!tag || !blockLen)
             break;
-        if (data + blockLen > end) {
-            ok = false;
-            break;
+        if (blockLen > quint32(end - data)) {
+            cd.appendError(QLatin1String("QM-Format error: truncated block"));
+            return false;
         }
 
-        if (tag == Hashes) {
-            offsetArray = data;
-            offsetLength = blockLen;
-            //qDebug() << "HASHES: " << blockLen << QByteArray((const char *)data, blockLen).toHex();
-        } else if (tag == Messages) {
-            messageArray = data;
-            //qDebug() << "MESSAGES: " << blockLen << QByteArray((const char *)data, blockLen).toHex();
-        } else if (tag == Dependencies) {
-            QStringList dependencies;
-            QDataStream stream(QByteArray::fromRawData((const char*)data, blockLen));
-            QString dep;
-            while (!stream.atEnd()) {
-                stream >> dep;
-                dependencies.append(dep);
+        const QByteArrayView block(data, blockLen);
+        if (tag == Hashes)
+            m_hashes = block;
+        else if (tag == Messages)
+            m_messages = block;
+        else if (tag == Dependencies)
+            m_dependencies = block;
+        else if (tag == Language)
+            m_language = block;
+
+        data += blockLen;
+    }
+    return true;
+}
+
+QStringList QmView::dependencies() const
+{
+    QStringList dependencies;
+    if (m_dependencies.isEmpty())
+        return dependencies;
+    QDataStream stream(QByteArray::fromRawData(m_dependencies.data(), m_dependencies.size()));
+    QString dep;
+    while (!stream.atEnd()) {
+        stream >> dep;
+        dependencies.append(dep);
+    }
+    return dependencies;
+}
+
+/*
+ * Reads the message at index in the hash table. Returns false if the
+ * message is not completely within the file.
+ */
+bool QmView::readMessage(int index, Message *msg) const
+{
+    const uchar *entry = reinterpret_cast<const uchar *>(m_hashes.data()) + 8 * index;
+    msg->hash = read32(entry);
+    const quint32 offset = read32(entry + 4);
+    if (offset >= quint32(m_messages.size()))
+        return false;
+    const uchar *m = reinterpret_cast<const uchar *>(m_messages.data()) + offset;
+    const uchar *end = reinterpret_cast<const uchar *>(m_messages.data()) + m_messages.size();
+
+    msg->translations.clear();
+    const auto readBlock = [&m, end](QByteArrayView *out) {
+        if (end - m < 4)
+            return false;
+        const quint32 len = read32(m);
+        m += 4;
+        if (len > quint32(end - m))
+            return false;
+        *out = QByteArrayView(m, len);
+        m += len;
+        return true;
+    };
+    while (m < end) {
+        switch (read8(m++)) {
+        case Tag_End:
+            return true;
+        case Tag_Translation: {
+            if (end - m < 4)
+                return false;
+            // -1 indicates an empty string
+            // Otherwise streaming format is UTF-16 -> 2 bytes per character
+            if (read32(m) == quint32(-1)) {
+                m += 4;
+                msg->translations.append(QByteArrayView());
+                break;
             }
-            translator.setDependencies(dependencies);
-        } else if (tag == Language) {
-            QString language;
-            fromBytes((const char *)data, blockLen, &language, &utf8Fail);
-            translator.setLanguageCode(language);
+            QByteArrayView translation;
+            if (!readBlock(&translation) || (translation.size() & 1))
+                return false;
+            msg->translations.append(translation);
+            break;
         }
+        case Tag_Obsolete1:
+            m += 4;
+            break;
+        case Tag_SourceText:
+            if (!readBlock(&msg->sourceText))
+                return false;
+            break;
+        case Tag_Context:
+            if (!readBlock(&msg->context))
+                return false;
+            break;
+        case Tag_Comment:
+            if (!readBlock(&msg->comment))
+                return false;
+            break;
+        default:
+            break;
+        }
+    }
+    return false;
+}
 
-        data += blockLen;
+QStringList QmView::Message::decodedTranslations() const
+{
+    QStringList decoded;
+    decoded.reserve(translations.size());
+    for (QByteArrayView translation : translations) {
+        QString str;
+        if (!translation.isNull()) {
+            str.resize(translation.size() / 2);
+            qFromBigEndian<char16_t>(translation.data(), str.size(), str.data());
+        }
+        decoded << str;
     }
+    return decoded;
+}
 
+bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
+{
+    QmView view;
+    if (!view.open(dev, cd))
+        return false;
 
-    size_t numItems = offsetLength / (2 * sizeof(quint32));
-    //qDebug() << "NUMITEMS: " << numItems;
+    bool utf8Fail = false;
+    translator.setDependencies(view.dependencies());
+    QString language;
+    fromBytes(view.languageCode(), &language, &utf8Fail);
+    translator.setLanguageCode(language);
 
     QString strProN = QLatin1String("%n");
     QLocale::Language l;
@@ -505,83 +614,27 @@ bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
     if (getNumerusInfo(l, c, 0, &numerusForms, 0))
         guessPlurals = (numerusForms.size() == 1);
 
+    // Consecutive messages mostly share their context, so it is only
+    // decoded again when it changes
+    QmView::Message viewMsg;
+    QByteArrayView contextBytes;
     QString context, sourcetext, comment;
-    QStringList translations;
-
-    for (const uchar *start = offsetArray; start != offsetArray + (numItems << 3); start += 8) {
-        //quint32 hash = read32(start);
-        quint32 ro = read32(start + 4);
-        //qDebug() << "\nHASH:" << hash;
-        const uchar *m = messageArray + ro;
-
-        for (;;) {
-            uchar tag = read8(m++);
-            //qDebug() << "Tag:" << tag << " ADDR: " << m;
-            switch(tag) {
-            case Tag_End:
-                goto end;
-            case Tag_Translation: {
-                int len = read32(m);
-                m += 4;
 
-                // -1 indicates an empty string
-                // Otherwise streaming format is UTF-16 -> 2 bytes per character
-                if ((len != -1) && (len & 1)) {
-                    cd.appendError(QLatin1String("QM-Format error"));
-                    return false;
-                }
-                QString str;
-                if (len != -1)
-                    str = QString((const QChar *)m, len / 2);
-                if (QSysInfo::ByteOrder == QSysInfo::LittleEndian) {
-                    for (int i = 0; i < str.size(); ++i)
-                        str[i] = QChar((str.at(i).unicode() >> 8) +
-                            ((str.at(i).unicode() << 8) & 0xff00));
-                }
-                translations << str;
-                m += len;
-                break;
-            }
-            case Tag_Obsolete1:
-                m += 4;
-                //qDebug() << "OBSOLETE";
-                break;
-            case Tag_SourceText: {
-                quint32 len = read32(m);
-                m += 4;
-                //qDebug() << "SOURCE LEN: " << len;
-                //qDebug() << "SOURCE: " << QByteArray((const char*)m, len);
-                fromBytes((const char*)m, len, &sourcetext, &utf8Fail);
-                m += len;
-                break;
-            }
-            case Tag_Context: {
-                quint32 len = read32(m);
-                m += 4;
-                //qDebug() << "CONTEXT LEN: " << len;
-                //qDebug() << "CONTEXT: " << QByteArray((const char*)m, len);
-                fromBytes((const char*)m, len, &context, &utf8Fail);
-                m += len;
-                break;
-            }
-            case Tag_Comment: {
-                quint32 len = read32(m);
-                m += 4;
-                //qDebug() << "COMMENT LEN: " << len;
-                //qDebug() << "COMMENT: " << QByteArray((const char*)m, len);
-                fromBytes((const char*)m, len, &comment, &utf8Fail);
-                m += len;
-                break;
-            }
-            default:
-                //qDebug() << "UNKNOWN TAG" << tag;
-                break;
-            }
+    for (int i = 0, count = view.messageCount(); i < count; ++i) {
+        if (!view.readMessage(i, &viewMsg)) {
+            cd.appendError(QLatin1String("QM-Format error"));
+            return false;
+        }
+        if (i == 0 || viewMsg.context != contextBytes) {
+            contextBytes = viewMsg.context;
+            fromBytes(contextBytes, &context, &utf8Fail);
         }
-    end:;
+        fromBytes(viewMsg.sourceText, &sourcetext, &utf8Fail);
+        fromBytes(viewMsg.comment, &comment, &utf8Fail);
+
         TranslatorMessage msg;
         msg.setType(TranslatorMessage::Finished);
-        if (translations.size() > 1) {
+        if (viewMsg.translations.size() > 1) {
             // If guessPlurals is not false here, plural form discard messages
             // will be spewn out later.
             msg.setPlural(true);
@@ -590,8 +643,7 @@ bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
             if (sourcetext.contains(strProN))
                 msg.setPlural(true);
         }
-        msg.setTranslations(translations);
-        translations.clear();
+        msg.setTranslations(viewMsg.decodedTranslations());
         msg.setContext(context);
         msg.setSourceText(sourcetext);
         msg.setComment(comment);
@@ -601,7 +653,7 @@ bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
         cd.appendError(QLatin1String("Error: File contains invalid UTF-8 sequences."));
         return false;
     }
-    return ok;
+    return true;
 }
 
 
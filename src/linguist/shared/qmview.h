@@ -0,0 +1,67 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef QMVIEW_H
+#define QMVIEW_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QByteArrayView>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVarLengthArray>
+
+QT_BEGIN_NAMESPACE
+
+class ConversionData;
+class QFile;
+class QIODevice;
+
+/*
+ * Reads the messages of a QM file in place, without building a Translator.
+ * A QFile is mapped into memory, other devices are read completely. The
+ * device must outlive the view. This is implemented in qm.cpp.
+ */
+class QmView
+{
+public:
+    // The strings of one message, pointing into the file. Texts are UTF-8,
+    // translations UTF-16 in big endian byte order.
+    struct Message
+    {
+        quint32 hash = 0;
+        QByteArrayView context;
+        QByteArrayView sourceText;
+        QByteArrayView comment;
+        QVarLengthArray<QByteArrayView, 2> translations;
+
+        QStringList decodedTranslations() const;
+    };
+
+    QmView() = default;
+    ~QmView();
+    QmView(const QmView &) = delete;
+    QmView &operator=(const QmView &) = delete;
+
+    bool open(QIODevice &dev, ConversionData &cd);
+
+    QByteArrayView languageCode() const { return m_language; }
+    QStringList dependencies() const;
+    int messageCount() const { return int(m_hashes.size() / 8); }
+
+    // Squeezed files leave out the texts that a message shares with the one
+    // before it, so these keep their value in msg from the previous call.
+    bool readMessage(int index, Message *msg) const;
+
+private:
+    QByteArray m_data; // unless mapped
+    QFile *m_mappedFile = nullptr;
+    uchar *m_mapped = nullptr;
+    QByteArrayView m_language;
+    QByteArrayView m_dependencies;
+    QByteArrayView m_hashes;
+    QByteArrayView m_messages;
+};
+
+QT_END_NAMESPACE
+
+#endif // QMVIEW_H
@@ -4,9 +4,13 @@
 #include "simtexth.h"
 #include "translator.h"
 
-#include <QtCore/QByteArray>
-#include <QtCore/QString>
 #include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtCore/qalgorithms.h>
+
+#include <algorithm>
+#include <vector>
 
 
 QT_BEGIN_NAMESPACE
@@ -34,6 +38,9 @@ typedef QList<TranslatorMessage> TML;
 
   The implementation differs from this in a few details.  Most importantly,
   repetitions are ignored; for input "xxx", M[x,x] equals 1, not 2.
+
+  The matrices are bitsets, so the sums are population counts of the
+  bitwise and and or of the matrices.
 */
 
 /*
@@ -71,131 +78,200 @@ static const int indexOf[256] = {
     15, 12, 16, 17, 18, 19, 2,  10, 15, 7,  19, 2,  6,  7,  10, 0
 };
 
-/*
-  The entry bitCount[i] (for i between 0 and 255) is the number of bits used to
-  represent i in binary.
-*/
-static const int bitCount[256] = {
-    0,  1,  1,  2,  1,  2,  2,  3,  1,  2,  2,  3,  2,  3,  3,  4,
-    1,  2,  2,  3,  2,  3,  3,  4,  2,  3,  3,  4,  3,  4,  4,  5,
-    1,  2,  2,  3,  2,  3,  3,  4,  2,  3,  3,  4,  3,  4,  4,  5,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    1,  2,  2,  3,  2,  3,  3,  4,  2,  3,  3,  4,  3,  4,  4,  5,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    3,  4,  4,  5,  4,  5,  5,  6,  4,  5,  5,  6,  5,  6,  6,  7,
-    1,  2,  2,  3,  2,  3,  3,  4,  2,  3,  3,  4,  3,  4,  4,  5,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    3,  4,  4,  5,  4,  5,  5,  6,  4,  5,  5,  6,  5,  6,  6,  7,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    3,  4,  4,  5,  4,  5,  5,  6,  4,  5,  5,  6,  5,  6,  6,  7,
-    3,  4,  4,  5,  4,  5,  5,  6,  4,  5,  5,  6,  5,  6,  6,  7,
-    4,  5,  5,  6,  5,  6,  6,  7,  5,  6,  6,  7,  6,  7,  7,  8
-};
-
-static inline void setCoOccurence(CoMatrix &m, char c, char d)
+static inline void setCoOccurence(CoMatrix &m, uchar c, uchar d)
 {
-    int k = indexOf[(uchar) c] + 20 * indexOf[(uchar) d];
+    int k = indexOf[c] + 20 * indexOf[d];
     m.b[k >> 3] |= (1 << (k & 0x7));
 }
 
+/*
+  The co-occurrences are those of consecutive bytes in the UTF-8 encoding of
+  the string, up to its first null character.  The string is encoded on the
+  fly, as QString::toUtf8() would do it, so that constructing a matrix does
+  not allocate.
+*/
 CoMatrix::CoMatrix(const QString &str)
 {
-    QByteArray ba = str.toUtf8();
-    const char *text = ba.constData();
-    char c = '\0', d;
-    memset( b, 0, 52 );
-    /*
-      The Knuth books are not in the office only for show; they help make
-      loops 30% faster and 20% as readable.
-    */
-    while ( (d = *text) != '\0' ) {
+    memset( b, 0, sizeof(b) );
+
+    uchar c = '\0';
+    const auto add = [this, &c](uchar d) {
         setCoOccurence(*this, c, d);
-        if ( (c = *++text) != '\0' ) {
-            setCoOccurence(*this, d, c);
-            text++;
+        c = d;
+    };
+    const qsizetype size = str.size();
+    for (qsizetype i = 0; i < size; ++i) {
+        const char16_t u = str.at(i).unicode();
+        if (u == 0) {
+            break;
+        } else if (u < 0x80) {
+            add(u);
+        } else if (u < 0x800) {
+            add(0xc0 | (u >> 6));
+            add(0x80 | (u & 0x3f));
+        } else if (!QChar::isSurrogate(u)) {
+            add(0xe0 | (u >> 12));
+            add(0x80 | ((u >> 6) & 0x3f));
+            add(0x80 | (u & 0x3f));
+        } else if (QChar::isHighSurrogate(u) && i + 1 < size
+                   && str.at(i + 1).isLowSurrogate()) {
+            const char32_t ucs4 = QChar::surrogateToUcs4(u, str.at(++i).unicode());
+            add(0xf0 | (ucs4 >> 18));
+            add(0x80 | ((ucs4 >> 12) & 0x3f));
+            add(0x80 | ((ucs4 >> 6) & 0x3f));
+            add(0x80 | (ucs4 & 0x3f));
+        } else {
+            // Unpaired surrogates are replaced, like in QString::toUtf8()
+            add('?');
         }
     }
 }
 
-static inline int worth(const CoMatrix &m)
+static inline int similarityScore(const CoMatrix &m, int mLength, const CoMatrix &n, int nLength)
 {
-    int w = 0;
-    for (int i = 0; i < 50; i++)
-        w += bitCount[m.b[i]];
-    return w;
+    int intersection = 0;
+    int reunion = 0;
+    for (int i = 0; i < 7; ++i) {
+        intersection += qPopulationCount(m.w[i] & n.w[i]);
+        reunion += qPopulationCount(m.w[i] | n.w[i]);
+    }
+    int delta = qAbs(mLength - nLength);
+    return ((intersection + 1) << 10) / (reunion + (delta << 1) + 1);
 }
 
-static inline CoMatrix reunion(const CoMatrix &m, const CoMatrix &n)
+StringSimilarityMatcher::StringSimilarityMatcher(const QString &stringToMatch)
+    : m_cm(stringToMatch)
 {
-    CoMatrix p;
-    for (int i = 0; i < 13; ++i)
-        p.w[i] = m.w[i] | n.w[i];
-    return p;
+    m_length = stringToMatch.size();
 }
 
-static inline CoMatrix intersection(const CoMatrix &m, const CoMatrix &n)
+int StringSimilarityMatcher::getSimilarityScore(const QString &strCandidate)
 {
-    CoMatrix p;
-    for (int i = 0; i < 13; ++i)
-        p.w[i] = m.w[i] & n.w[i];
-    return p;
+    return similarityScore(m_cm, m_length, CoMatrix(strCandidate), strCandidate.size());
 }
 
-StringSimilarityMatcher::StringSimilarityMatcher(const QString &stringToMatch)
-    : m_cm(stringToMatch)
+void StringSimilarityIndex::reserve(qsizetype size)
 {
-    m_length = stringToMatch.size();
+    m_matrices.reserve(size);
+    m_lengths.reserve(size);
 }
 
-int StringSimilarityMatcher::getSimilarityScore(const QString &strCandidate)
+void StringSimilarityIndex::append(const QString &candidate)
+{
+    m_matrices.append(CoMatrix(candidate));
+    m_lengths.append(candidate.size());
+}
+
+void StringSimilarityIndex::clear()
 {
-    CoMatrix cmTarget(strCandidate);
-    int delta = qAbs(m_length - strCandidate.size());
-    int score = ( (worth(intersection(m_cm, cmTarget)) + 1) << 10 ) /
-        ( worth(reunion(m_cm, cmTarget)) + (delta << 1) + 1 );
-    return score;
+    m_matrices.clear();
+    m_lengths.clear();
+}
+
+/*
+  Returns the positions of at most \a maxMatches candidates whose score
+  against \a stringToMatch reaches textSimilarityThreshold, best first.
+  Candidates with the same score are returned in the order in which they
+  were appended.  If \a scores is not null, it receives the score of each
+  returned candidate.  If \a eligible is not null, only the candidates
+  whose bit is set in it are considered.
+
+  The best candidates found so far are kept in a heap whose front is the
+  worst of them, so that a candidate costs more than its score only if
+  it is better than that one.
+
+  The intersection of two matrices has at most as many bits as the matrix
+  of \a stringToMatch, and their union at least as many, so the length
+  difference alone bounds the score.  Candidates whose length differs too
+  much to reach the score needed are skipped without scoring them.
+*/
+QList<int> StringSimilarityIndex::bestMatches(const QString &stringToMatch, int maxMatches,
+                                              QList<int> *scores,
+                                              const QBitArray *eligible) const
+{
+    using Match = std::pair<int, int>; // score, position
+    const auto better = [](const Match &a, const Match &b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    };
+
+    std::vector<Match> heap;
+    if (maxMatches > 0) {
+        heap.reserve(maxMatches);
+        const CoMatrix cm(stringToMatch);
+        const int length = stringToMatch.size();
+        int bits = 0;
+        for (int i = 0; i < 7; ++i)
+            bits += qPopulationCount(cm.w[i]);
+        // The largest length difference that still allows a score of minScore
+        const auto maxDeltaFor = [bits](int minScore) {
+            return (((bits + 1) << 10) / minScore - bits - 1) / 2;
+        };
+        int maxDelta = maxDeltaFor(textSimilarityThreshold);
+
+        const CoMatrix *matrices = m_matrices.constData();
+        const int *lengths = m_lengths.constData();
+        const int count = int(m_lengths.size());
+        for (int i = 0; i < count; ++i) {
+            if (qAbs(length - lengths[i]) > maxDelta || (eligible && !eligible->testBit(i)))
+                continue;
+            const int score = similarityScore(cm, length, matrices[i], lengths[i]);
+            if (score < textSimilarityThreshold)
+                continue;
+            if (heap.size() < size_t(maxMatches)) {
+                heap.emplace_back(score, i);
+                std::push_heap(heap.begin(), heap.end(), better);
+            } else if (score > heap.front().first) {
+                std::pop_heap(heap.begin(), heap.end(), better);
+                heap.back() = Match(score, i);
+                std::push_heap(heap.begin(), heap.end(), better);
+            } else {
+                continue;
+            }
+            // Later candidates must at least tie with the worst one kept
+            if (heap.size() == size_t(maxMatches))
+                maxDelta = maxDeltaFor(heap.front().first);
+        }
+        std::sort_heap(heap.begin(), heap.end(), better);
+    }
+
+    QList<int> positions;
+    positions.reserve(heap.size());
+    if (scores) {
+        scores->clear();
+        scores->reserve(heap.size());
+    }
+    for (const Match &match : heap) {
+        positions.append(match.second);
+        if (scores)
+            scores->append(match.first);
+    }
+    return positions;
 }
 
 CandidateList similarTextHeuristicCandidates(const Translator *tor,
     const QString &text, int maxCandidates)
 {
-    QList<int> scores;
-    CandidateList candidates;
-    StringSimilarityMatcher matcher(text);
+    CandidateList translated;
+    QSet<Candidate> seen;
+    StringSimilarityIndex index;
 
     for (const TranslatorMessage &mtm : tor->messages()) {
         if (mtm.type() == TranslatorMessage::Unfinished
             || mtm.translation().isEmpty())
             continue;
 
-        QString s = mtm.sourceText();
-        int score = matcher.getSimilarityScore(s);
-
-        if (candidates.size() == maxCandidates && score > scores[maxCandidates - 1] )
-            candidates.removeLast();
-
-        if (candidates.size() < maxCandidates && score >= textSimilarityThreshold) {
-            Candidate cand(mtm.context(), s, mtm.comment(), mtm.translation());
-
-            int i;
-            for (i = 0; i < candidates.size(); i++) {
-                if (score >= scores.at(i)) {
-                    if (score == scores.at(i)) {
-                        if (candidates.at(i) == cand)
-                            goto continue_outer_loop;
-                    } else {
-                        break;
-                    }
-                }
-            }
-            scores.insert(i, score);
-            candidates.insert(i, cand);
-        }
-        continue_outer_loop:
-        ;
+        Candidate cand(mtm.context(), mtm.sourceText(), mtm.comment(), mtm.translation());
+        if (seen.contains(cand))
+            continue;
+        seen.insert(cand);
+        translated.append(cand);
+        index.append(cand.source);
     }
+
+    CandidateList candidates;
+    const QList<int> matches = index.bestMatches(text, maxCandidates);
+    for (int i : matches)
+        candidates.append(translated.at(i));
     return candidates;
 }
 
@@ -6,6 +6,7 @@
 
 const int textSimilarityThreshold = 190;
 
+#include <QBitArray>
 #include <QString>
 #include <QList>
 
@@ -33,6 +34,10 @@ inline bool operator==( const Candidate& c, const Candidate& d ) {
 inline bool operator!=( const Candidate& c, const Candidate& d ) {
     return !operator==( c, d );
 }
+inline size_t qHash(const Candidate &c, size_t seed = 0)
+{
+    return qHashMulti(seed, c.context, c.source, c.disambiguation, c.translation);
+}
 
 typedef QList<Candidate> CandidateList;
 
@@ -42,12 +47,12 @@ struct CoMatrix
     CoMatrix() {}
 
     /*
-      The matrix has 20 * 20 = 400 entries.  This requires 50 bytes, or 13
-      words.  Some operations are performed on words for more efficiency.
+      The matrix has 20 * 20 = 400 entries.  This requires 50 bytes, or 7
+      64-bit words.  Some operations are performed on words for more efficiency.
     */
     union {
-        quint8 b[52];
-        quint32 w[13];
+        quint8 b[56];
+        quint64 w[7];
     };
 };
 
@@ -67,6 +72,28 @@ private:
     int m_length;
 };
 
+/**
+ * This class scores a string against a fixed set of candidate strings.
+ * The CoMatrix of each candidate is constructed once when it is appended,
+ * so that the same candidates can be searched for any number of strings.
+ * \sa StringSimilarityMatcher
+ */
+class StringSimilarityIndex {
+public:
+    void reserve(qsizetype size);
+    void append(const QString &candidate);
+    void clear();
+    qsizetype size() const { return m_lengths.size(); }
+
+    QList<int> bestMatches(const QString &stringToMatch, int maxMatches,
+                           QList<int> *scores = nullptr,
+                           const QBitArray *eligible = nullptr) const;
+
+private:
+    QList<CoMatrix> m_matrices;
+    QList<int> m_lengths;
+};
+
 /**
  * Checks how similar two strings are.
  * The return value is the score, and a higher score is more similar
@@ -5,7 +5,10 @@
 
 #include "simtexth.h"
 
+#include <algorithm>
 #include <iostream>
+#include <numeric>
+#include <vector>
 
 #include <stdio.h>
 #ifdef Q_OS_WIN
@@ -49,14 +52,32 @@ QList<Translator::FileFormat> &Translator::registeredFileFormats()
     return theFormats;
 }
 
-void Translator::addIndex(int idx, const TranslatorMessage &msg) const
+void Translator::ensureIds() const
+{
+    if (!m_idsOk) {
+        m_idsOk = true;
+        m_ids.resize(m_messages.size());
+        std::iota(m_ids.begin(), m_ids.end(), 0);
+        m_rows = m_ids;
+        m_rowsDirtyFrom = m_ids.size();
+    }
+}
+
+// Updates the rows of the ids behind the first insertion since the last call.
+void Translator::ensureRows() const
+{
+    for (; m_rowsDirtyFrom < m_ids.size(); ++m_rowsDirtyFrom)
+        m_rows[m_ids.at(m_rowsDirtyFrom)] = int(m_rowsDirtyFrom);
+}
+
+void Translator::addIndex(int id, const TranslatorMessage &msg) const
 {
     if (msg.sourceText().isEmpty() && msg.id().isEmpty()) {
-        m_ctxCmtIdx[msg.context()] = idx;
+        m_ctxCmtIdx[msg.context()] = id;
     } else {
-        m_msgIdx[TMMKey(msg)] = idx;
+        m_msgIdx[TMMKey(msg)] = id;
         if (!msg.id().isEmpty())
-            m_idMsgIdx[msg.id()] = idx;
+            m_idMsgIdx[msg.id()] = id;
     }
 }
 
@@ -79,8 +100,82 @@ void Translator::ensureIndexed() const
         m_ctxCmtIdx.clear();
         m_idMsgIdx.clear();
         m_msgIdx.clear();
+        ensureIds();
+        for (int i = 0; i < m_messages.size(); i++)
+            addIndex(m_ids.at(i), m_messages.at(i));
+    }
+}
+
+static std::pair<QString, QString> fileIndexKey(const TranslatorMessage &msg)
+{
+    return { msg.fileName(), msg.context() };
+}
+
+void Translator::addFileIndex(int id, const TranslatorMessage &msg) const
+{
+    QList<int> &ids = m_fileIdx[fileIndexKey(msg)];
+    const int row = rowOf(id);
+    if (ids.isEmpty() || rowOf(ids.last()) < row) {
+        ids.append(id);
+        return;
+    }
+    ids.insert(std::lower_bound(ids.begin(), ids.end(), row,
+                                [this](int other, int row) { return rowOf(other) < row; }),
+               id);
+}
+
+void Translator::delFileIndex(int idx) const
+{
+    const auto it = m_fileIdx.find(fileIndexKey(m_messages.at(idx)));
+    if (it == m_fileIdx.end())
+        return;
+    const auto pos = std::lower_bound(it->begin(), it->end(), idx,
+                                      [this](int other, int row) { return rowOf(other) < row; });
+    if (pos != it->end() && *pos == m_ids.at(idx))
+        it->erase(pos);
+}
+
+void Translator::ensureFileIndexed() const
+{
+    if (!m_fileIdxOk) {
+        m_fileIdxOk = true;
+        m_fileIdx.clear();
+        ensureIds();
+        for (int i = 0; i < m_messages.size(); i++)
+            m_fileIdx[fileIndexKey(m_messages.at(i))].append(m_ids.at(i));
+    }
+}
+
+void Translator::addRefIndex(int id, const TranslatorMessage &msg) const
+{
+    for (const TranslatorMessage::Reference &ref : msg.allReferences()) {
+        QList<int> &ids = m_refIdx[TMMRefKey(msg.context(), msg.comment(), ref)];
+        if (!ids.contains(id))
+            ids.append(id);
+    }
+}
+
+void Translator::delRefIndex(int idx) const
+{
+    const TranslatorMessage &msg = m_messages.at(idx);
+    for (const TranslatorMessage::Reference &ref : msg.allReferences()) {
+        const auto it = m_refIdx.find(TMMRefKey(msg.context(), msg.comment(), ref));
+        if (it != m_refIdx.end()) {
+            it->removeOne(m_ids.at(idx));
+            if (it->isEmpty())
+                m_refIdx.erase(it);
+        }
+    }
+}
+
+void Translator::ensureRefIndexed() const
+{
+    if (!m_refIdxOk) {
+        m_refIdxOk = true;
+        m_refIdx.clear();
+        ensureIds();
         for (int i = 0; i < m_messages.size(); i++)
-            addIndex(i, m_messages.at(i));
+            addRefIndex(m_ids.at(i), m_messages.at(i));
     }
 }
 
@@ -91,8 +186,16 @@ void Translator::replaceSorted(const TranslatorMessage &msg)
         appendSorted(msg);
     } else {
         delIndex(index);
+        if (m_fileIdxOk)
+            delFileIndex(index);
+        if (m_refIdxOk)
+            delRefIndex(index);
         m_messages[index] = msg;
-        addIndex(index, msg);
+        addIndex(m_ids.at(index), msg);
+        if (m_fileIdxOk)
+            addFileIndex(m_ids.at(index), msg);
+        if (m_refIdxOk)
+            addRefIndex(m_ids.at(index), msg);
     }
 }
 
@@ -119,7 +222,7 @@ void Translator::extend(const TranslatorMessage &msg, ConversionData &cd)
         if (emsg.sourceText().isEmpty()) {
             delIndex(index);
             emsg.setSourceText(msg.sourceText());
-            addIndex(index, msg);
+            addIndex(m_ids.at(index), msg);
         } else if (!msg.sourceText().isEmpty() && emsg.sourceText() != msg.sourceText()) {
             cd.appendError(QString::fromLatin1("Contradicting source strings for message with id '%1'.")
                            .arg(emsg.id()));
@@ -134,7 +237,16 @@ void Translator::extend(const TranslatorMessage &msg, ConversionData &cd)
                                 : QString::fromLatin1("message '%1'").arg(makeMsgId(msg))));
             return;
         }
+        if (emsg.fileName().isEmpty())
+            m_fileIdxOk = false;
         emsg.addReferenceUniq(msg.fileName(), msg.lineNumber());
+        if (m_refIdxOk && !msg.fileName().isEmpty()) {
+            QList<int> &ids = m_refIdx[TMMRefKey(
+                    emsg.context(), emsg.comment(),
+                    TranslatorMessage::Reference(msg.fileName(), msg.lineNumber()))];
+            if (!ids.contains(m_ids.at(index)))
+                ids.append(m_ids.at(index));
+        }
         if (!msg.extraComment().isEmpty()) {
             QString cmt = emsg.extraComment();
             if (!cmt.isEmpty()) {
@@ -149,17 +261,33 @@ void Translator::extend(const TranslatorMessage &msg, ConversionData &cd)
             emsg.setExtraComment(cmt);
         }
     }
+    if (m_extendLog)
+        m_extendLog->append(msg);
 }
 
 void Translator::insert(int idx, const TranslatorMessage &msg)
 {
-    if (m_indexOk) {
-        if (idx == m_messages.size())
-            addIndex(idx, msg);
-        else
-            m_indexOk = false;
-    }
     m_messages.insert(idx, msg);
+    if (!m_idsOk)
+        return;
+
+    // The rows of the messages behind idx are only updated once one of
+    // them is looked up.
+    const int id = int(m_rows.size());
+    const bool rowsUpToDate = m_rowsDirtyFrom == m_ids.size();
+    m_ids.insert(idx, id);
+    m_rows.append(idx);
+    if (rowsUpToDate && idx == m_ids.size() - 1)
+        m_rowsDirtyFrom = m_ids.size();
+    else
+        m_rowsDirtyFrom = qMin(m_rowsDirtyFrom, qsizetype(idx));
+
+    if (m_indexOk)
+        addIndex(id, msg);
+    if (m_fileIdxOk)
+        addFileIndex(id, msg);
+    if (m_refIdxOk)
+        addRefIndex(id, msg);
 }
 
 void Translator::append(const TranslatorMessage &msg)
@@ -167,63 +295,246 @@ void Translator::append(const TranslatorMessage &msg)
     insert(m_messages.size(), msg);
 }
 
-void Translator::appendSorted(const TranslatorMessage &msg)
+namespace {
+
+// Where appendSorted() inserts a message, as an index into the positions of
+// the messages with the same file name and context.
+struct SortedInsertion
 {
-    int msgLine = msg.lineNumber();
-    if (msgLine < 0) {
-        append(msg);
-        return;
-    }
+    int pos = -1; // -1 if the message is appended
+    bool after = false; // After positions[pos - 1] instead of before positions[pos]
+};
 
-    int bestIdx = 0; // Best insertion point found so far
+}
+
+/*
+    Finds the place for a message with the line number \a msgLine among the
+    \a positions of the messages from the same file and context.
+
+    The messages are split into regions: runs of adjacent messages with
+    the same file name and context, and ascending line numbers. The
+    message goes into the middle of a region whose line numbers enclose
+    its own, or else before or after a region, preferring longer regions.
+    Only the positions of the messages with the same file name and context
+    are visited, as all other messages merely end a region.
+*/
+template <typename LineAt, typename Adjacent>
+static SortedInsertion findSortedInsertion(int msgLine, const QList<int> &positions,
+                                           LineAt lineAt, Adjacent adjacent)
+{
+    SortedInsertion best; // Best insertion point found so far
     int bestScore = 0; // Its category: 0 = no hit, 1 = pre or post, 2 = middle
     int bestSize = 0; // The length of the region. Longer is better within one category.
 
     // The insertion point to use should this region turn out to be the best one so far
-    int thisIdx = 0;
+    SortedInsertion current;
     int thisScore = 0;
     int thisSize = 0;
     // Working vars
     int prevLine = 0;
-    int curIdx = 0;
-    for (const TranslatorMessage &mit : std::as_const(m_messages)) {
-        bool sameFile = mit.fileName() == msg.fileName() && mit.context() == msg.context();
-        int curLine;
-        if (sameFile && (curLine = mit.lineNumber()) >= prevLine) {
+
+    // Ends the current region before the message at positions[pos], or after
+    // the one at positions[pos - 1].
+    const auto endRegion = [&](int pos, bool after) {
+        if (!thisScore) {
+            current = { pos, after };
+            thisScore = 1;
+        }
+        if (thisScore > bestScore || (thisScore == bestScore && thisSize > bestSize)) {
+            best = current;
+            bestScore = thisScore;
+            bestSize = thisSize;
+        }
+        thisScore = 0;
+        thisSize = after ? 0 : 1;
+        prevLine = 0;
+    };
+
+    for (qsizetype i = 0; i < positions.size(); ++i) {
+        const int curIdx = positions.at(i);
+        // A message from another file or context ends the region.
+        if (thisSize && i > 0 && !adjacent(positions.at(i - 1), curIdx))
+            endRegion(i, true);
+
+        int curLine = lineAt(curIdx);
+        if (curLine >= prevLine) {
             if (msgLine >= prevLine && msgLine < curLine) {
-                thisIdx = curIdx;
+                current = { int(i), false };
                 thisScore = thisSize ? 2 : 1;
             }
             ++thisSize;
             prevLine = curLine;
-        } else {
-            if (thisSize) {
-                if (!thisScore) {
-                    thisIdx = curIdx;
-                    thisScore = 1;
-                }
-                if (thisScore > bestScore || (thisScore == bestScore && thisSize > bestSize)) {
-                    bestIdx = thisIdx;
-                    bestScore = thisScore;
-                    bestSize = thisSize;
-                }
-                thisScore = 0;
-                thisSize = sameFile ? 1 : 0;
-                prevLine = 0;
-            }
+        } else if (thisSize) {
+            endRegion(i, false);
         }
-        ++curIdx;
     }
-    if (thisSize && !thisScore) {
-        thisIdx = curIdx;
-        thisScore = 1;
+    if (thisSize)
+        endRegion(positions.size(), true);
+
+    return bestScore ? best : SortedInsertion();
+}
+
+/*
+    Inserts \a msg next to the messages from the same file and context.
+*/
+void Translator::appendSorted(const TranslatorMessage &msg)
+{
+    int msgLine = msg.lineNumber();
+    if (msgLine < 0) {
+        append(msg);
+        return;
     }
-    if (thisScore > bestScore || (thisScore == bestScore && thisSize > bestSize))
-        insert(thisIdx, msg);
-    else if (bestScore)
-        insert(bestIdx, msg);
-    else
+
+    ensureFileIndexed();
+    const QList<int> ids = m_fileIdx.value(fileIndexKey(msg));
+    const SortedInsertion at = findSortedInsertion(
+            msgLine, ids,
+            [this](int id) { return m_messages.at(rowOf(id)).lineNumber(); },
+            [this](int id, int nextId) { return rowOf(nextId) == rowOf(id) + 1; });
+
+    if (at.pos < 0)
         append(msg);
+    else if (at.after)
+        insert(rowOf(ids.at(at.pos - 1)) + 1, msg);
+    else
+        insert(rowOf(ids.at(at.pos)), msg);
+}
+
+/*
+    Does the same as calling replaceSorted() for each of \a messages.
+
+    Inserting into the list one message at a time moves all messages
+    behind it and shifts their positions in the indexes, so merging big
+    files is quadratic. Instead, the messages are kept in a linked list
+    until all of them are merged. The indexes of find() and appendSorted()
+    refer to the nodes of the list, which never move.
+*/
+void Translator::replaceSorted(const QList<TranslatorMessage> &messages)
+{
+    if (messages.isEmpty())
+        return;
+
+    // The existing messages keep their rows as node numbers.
+    ensureIndexed();
+    QHash<TMMKey, int> msgIdx = m_msgIdx;
+    QHash<QString, int> idMsgIdx = m_idMsgIdx;
+    for (int &node : msgIdx)
+        node = rowOf(node);
+    for (int &node : idMsgIdx)
+        node = rowOf(node);
+
+    TMM nodes = std::move(m_messages);
+    m_messages = TMM();
+    const int oldCount = nodes.size();
+    nodes.reserve(oldCount + messages.size());
+    std::vector<int> prev, next;
+    prev.reserve(oldCount + messages.size());
+    next.reserve(oldCount + messages.size());
+    QHash<std::pair<QString, QString>, QList<int>> fileIdx;
+    for (int i = 0; i < oldCount; ++i) {
+        prev.push_back(i - 1);
+        next.push_back(i + 1 < oldCount ? i + 1 : -1);
+        fileIdx[fileIndexKey(nodes.at(i))].append(i);
+    }
+    int head = oldCount ? 0 : -1;
+    int tail = oldCount - 1;
+
+    // Inserts node in front of succ, or at the end if succ is -1.
+    const auto link = [&](int node, int succ) {
+        const int pred = succ < 0 ? tail : prev[succ];
+        prev[node] = pred;
+        next[node] = succ;
+        (pred < 0 ? head : next[pred]) = node;
+        (succ < 0 ? tail : prev[succ]) = node;
+    };
+
+    // The order of the nodes in the list. Only needed when a replacement
+    // moves a message to another file or context, so it is computed lazily.
+    std::vector<int> ranks;
+    bool ranksOk = false;
+    const auto rankLess = [&](int node, int other) {
+        if (!ranksOk) {
+            ranks.resize(nodes.size());
+            int rank = 0;
+            for (int i = head; i >= 0; i = next[i])
+                ranks[i] = rank++;
+            ranksOk = true;
+        }
+        return ranks[node] < ranks[other];
+    };
+
+    // These mirror find(), addIndex() and delIndex().
+    const auto findNode = [&](const TranslatorMessage &msg) {
+        if (msg.id().isEmpty())
+            return msgIdx.value(TMMKey(msg), -1);
+        int i = idMsgIdx.value(msg.id(), -1);
+        if (i >= 0)
+            return i;
+        i = msgIdx.value(TMMKey(msg), -1);
+        return i >= 0 && nodes.at(i).id().isEmpty() ? i : -1;
+    };
+    const auto addNodeIndex = [&](int node) {
+        const TranslatorMessage &msg = nodes.at(node);
+        if (msg.sourceText().isEmpty() && msg.id().isEmpty())
+            return;
+        msgIdx[TMMKey(msg)] = node;
+        if (!msg.id().isEmpty())
+            idMsgIdx[msg.id()] = node;
+    };
+    const auto delNodeIndex = [&](int node) {
+        const TranslatorMessage &msg = nodes.at(node);
+        if (msg.sourceText().isEmpty() && msg.id().isEmpty())
+            return;
+        msgIdx.remove(TMMKey(msg));
+        if (!msg.id().isEmpty())
+            idMsgIdx.remove(msg.id());
+    };
+
+    for (const TranslatorMessage &msg : messages) {
+        int node = findNode(msg);
+        if (node >= 0) {
+            delNodeIndex(node);
+            const auto oldKey = fileIndexKey(nodes.at(node));
+            nodes[node] = msg;
+            addNodeIndex(node);
+            const auto newKey = fileIndexKey(msg);
+            if (newKey != oldKey) {
+                fileIdx[oldKey].removeOne(node);
+                QList<int> &positions = fileIdx[newKey];
+                positions.insert(std::lower_bound(positions.begin(), positions.end(), node,
+                                                  rankLess),
+                                 node);
+            }
+            continue;
+        }
+
+        node = nodes.size();
+        nodes.append(msg);
+        prev.push_back(-1);
+        next.push_back(-1);
+        ranksOk = false;
+        QList<int> &positions = fileIdx[fileIndexKey(msg)];
+        SortedInsertion at;
+        if (msg.lineNumber() >= 0) {
+            at = findSortedInsertion(
+                    msg.lineNumber(), positions,
+                    [&nodes](int n) { return nodes.at(n).lineNumber(); },
+                    [&next](int n, int nextNode) { return next[n] == nextNode; });
+        }
+        if (at.pos < 0) {
+            link(node, -1);
+            positions.append(node);
+        } else {
+            link(node, at.after ? next[positions.at(at.pos - 1)] : positions.at(at.pos));
+            positions.insert(at.pos, node);
+        }
+        addNodeIndex(node);
+    }
+
+    m_messages.reserve(nodes.size());
+    for (int i = head; i >= 0; i = next[i])
+        m_messages.append(std::move(nodes[i]));
+    invalidateIndexes();
 }
 
 static QString guessFormat(const QString &filename, const QString &format)
@@ -243,9 +554,6 @@ static QString guessFormat(const QString &filename, const QString &format)
 
 bool Translator::load(const QString &filename, ConversionData &cd, const QString &format)
 {
-    cd.m_sourceDir = QFileInfo(filename).absoluteDir();
-    cd.m_sourceFileName = filename;
-
     QFile file;
     if (filename.isEmpty() || filename == QLatin1String("-")) {
 #ifdef Q_OS_WIN
@@ -266,12 +574,22 @@ bool Translator::load(const QString &filename, ConversionData &cd, const QString
         }
     }
 
+    return load(file, filename, cd, format);
+}
+
+bool Translator::load(QIODevice &dev, const QString &filename, ConversionData &cd,
+                      const QString &format)
+{
+    cd.m_sourceDir = QFileInfo(filename).absoluteDir();
+    cd.m_sourceFileName = filename;
+
     QString fmt = guessFormat(filename, format);
 
     for (const FileFormat &format : std::as_const(registeredFileFormats())) {
         if (fmt == format.extension) {
+            TranslatorMessage::InternScope internScope;
             if (format.loader)
-                return (*format.loader)(*this, file, cd);
+                return (*format.loader)(*this, dev, cd);
             cd.appendError(QString(QLatin1String("No loader for format %1 found"))
                 .arg(fmt));
             return false;
@@ -361,11 +679,11 @@ int Translator::find(const TranslatorMessage &msg) const
 {
     ensureIndexed();
     if (msg.id().isEmpty())
-        return m_msgIdx.value(TMMKey(msg), -1);
-    int i = m_idMsgIdx.value(msg.id(), -1);
+        return rowOf(m_msgIdx.value(TMMKey(msg), -1));
+    int i = rowOf(m_idMsgIdx.value(msg.id(), -1));
     if (i >= 0)
         return i;
-    i = m_msgIdx.value(TMMKey(msg), -1);
+    i = rowOf(m_msgIdx.value(TMMKey(msg), -1));
     // If both have an id, then find only by id.
     return i >= 0 && m_messages.at(i).id().isEmpty() ? i : -1;
 }
@@ -373,55 +691,53 @@ int Translator::find(const TranslatorMessage &msg) const
 int Translator::find(const QString &context,
     const QString &comment, const TranslatorMessage::References &refs) const
 {
+    // Return the first message that has any of the references.
+    int found = -1;
     if (!refs.isEmpty()) {
-        for (auto it = m_messages.cbegin(), end = m_messages.cend(); it != end; ++it) {
-            if (it->context() == context && it->comment() == comment) {
-                for (const auto &itref : it->allReferences()) {
-                    for (const auto &ref : refs) {
-                        if (itref == ref)
-                            return it - m_messages.cbegin();
-                    }
-                }
+        ensureRefIndexed();
+        for (const auto &ref : refs) {
+            const auto it = m_refIdx.constFind(TMMRefKey(context, comment, ref));
+            if (it == m_refIdx.cend())
+                continue;
+            for (int id : *it) {
+                const int row = rowOf(id);
+                if (found < 0 || row < found)
+                    found = row;
             }
         }
     }
-    return -1;
+    return found;
 }
 
 int Translator::find(const QString &context) const
 {
     ensureIndexed();
-    return m_ctxCmtIdx.value(context, -1);
+    return rowOf(m_ctxCmtIdx.value(context, -1));
 }
 
 void Translator::stripObsoleteMessages()
 {
-    for (auto it = m_messages.begin(); it != m_messages.end(); )
-        if (it->type() == TranslatorMessage::Obsolete || it->type() == TranslatorMessage::Vanished)
-            it = m_messages.erase(it);
-        else
-            ++it;
-    m_indexOk = false;
+    m_messages.removeIf([](const TranslatorMessage &msg) {
+        return msg.type() == TranslatorMessage::Obsolete
+               || msg.type() == TranslatorMessage::Vanished;
+    });
+    invalidateIndexes();
 }
 
 void Translator::stripFinishedMessages()
 {
-    for (auto it = m_messages.begin(); it != m_messages.end(); )
-        if (it->type() == TranslatorMessage::Finished)
-            it = m_messages.erase(it);
-        else
-            ++it;
-    m_indexOk = false;
+    m_messages.removeIf([](const TranslatorMessage &msg) {
+        return msg.type() == TranslatorMessage::Finished;
+    });
+    invalidateIndexes();
 }
 
 void Translator::stripUntranslatedMessages()
 {
-    for (auto it = m_messages.begin(); it != m_messages.end(); )
-        if (!it->isTranslated())
-            it = m_messages.erase(it);
-        else
-            ++it;
-    m_indexOk = false;
+    m_messages.removeIf([](const TranslatorMessage &msg) {
+        return !msg.isTranslated();
+    });
+    invalidateIndexes();
 }
 
 bool Translator::translationsExist() const
@@ -435,34 +751,27 @@ bool Translator::translationsExist() const
 
 void Translator::stripEmptyContexts()
 {
-    for (auto it = m_messages.begin(); it != m_messages.end(); )
-        if (it->sourceText() == QLatin1String(ContextComment))
-            it = m_messages.erase(it);
-        else
-            ++it;
-    m_indexOk = false;
+    m_messages.removeIf([](const TranslatorMessage &msg) {
+        return msg.sourceText() == QLatin1String(ContextComment);
+    });
+    invalidateIndexes();
 }
 
 void Translator::stripNonPluralForms()
 {
-    for (auto it = m_messages.begin(); it != m_messages.end(); )
-        if (!it->isPlural())
-            it = m_messages.erase(it);
-        else
-            ++it;
-    m_indexOk = false;
+    m_messages.removeIf([](const TranslatorMessage &msg) {
+        return !msg.isPlural();
+    });
+    invalidateIndexes();
 }
 
 void Translator::stripIdenticalSourceTranslations()
 {
-    for (auto it = m_messages.begin(); it != m_messages.end(); ) {
+    m_messages.removeIf([](const TranslatorMessage &msg) {
         // we need to have just one translation, and it be equal to the source
-        if (it->translations().size() == 1 && it->translation() == it->sourceText())
-            it = m_messages.erase(it);
-        else
-            ++it;
-    }
-    m_indexOk = false;
+        return msg.translations().size() == 1 && msg.translation() == msg.sourceText();
+    });
+    invalidateIndexes();
 }
 
 void Translator::dropTranslations()
@@ -492,6 +801,8 @@ void Translator::dropUiLines()
         }
         message.setReferences(refs);
     }
+    m_fileIdxOk = false;
+    m_refIdxOk = false;
 }
 
 class TranslatorMessagePtrBase
@@ -600,7 +911,7 @@ Translator::Duplicates Translator::resolveDuplicates()
         (*pDup)[oi].append(msg.tsLineNumber());
         if (!omsg->isTranslated() && msg.isTranslated())
             omsg->setTranslations(msg.translations());
-        m_indexOk = false;
+        invalidateIndexes();
         m_messages.removeAt(i);
     }
     return dups;
@@ -608,39 +919,46 @@ Translator::Duplicates Translator::resolveDuplicates()
 
 void Translator::reportDuplicates(const Duplicates &dupes,
                                   const QString &fileName, bool verbose)
+{
+    reportDuplicates(dupes, fileName, verbose, std::cerr);
+}
+
+void Translator::reportDuplicates(const Duplicates &dupes,
+                                  const QString &fileName, bool verbose, std::ostream &out)
 {
     if (!dupes.byId.isEmpty() || !dupes.byContents.isEmpty()) {
-        std::cerr << "Warning: dropping duplicate messages in '" << qPrintable(fileName);
+        out << "Warning: dropping duplicate messages in '" << qPrintable(fileName);
         if (!verbose) {
-            std::cerr << "'\n(try -verbose for more info).\n";
+            out << "'\n(try -verbose for more info).\n";
         } else {
-            std::cerr << "':\n";
+            out << "':\n";
             for (auto it = dupes.byId.begin(); it != dupes.byId.end(); ++it) {
                 const TranslatorMessage &msg = message(it.key());
-                std::cerr << "\n* ID: " << qPrintable(msg.id()) << std::endl;
-                reportDuplicatesLines(msg, it.value());
+                out << "\n* ID: " << qPrintable(msg.id()) << std::endl;
+                reportDuplicatesLines(msg, it.value(), out);
             }
             for (auto it = dupes.byContents.begin(); it != dupes.byContents.end(); ++it) {
                 const TranslatorMessage &msg = message(it.key());
-                std::cerr << "\n* Context: " << qPrintable(msg.context())
-                          << "\n* Source: " << qPrintable(msg.sourceText()) << std::endl;
+                out << "\n* Context: " << qPrintable(msg.context())
+                    << "\n* Source: " << qPrintable(msg.sourceText()) << std::endl;
                 if (!msg.comment().isEmpty())
-                    std::cerr << "* Comment: " << qPrintable(msg.comment()) << std::endl;
-                reportDuplicatesLines(msg, it.value());
+                    out << "* Comment: " << qPrintable(msg.comment()) << std::endl;
+                reportDuplicatesLines(msg, it.value(), out);
             }
-            std::cerr << std::endl;
+            out << std::endl;
         }
     }
 }
 
 void Translator::reportDuplicatesLines(const TranslatorMessage &msg,
-                                       const DuplicateEntries::value_type &dups) const
+                                       const DuplicateEntries::value_type &dups,
+                                       std::ostream &out) const
 {
     if (msg.tsLineNumber() >= 0) {
-        std::cerr << "* Line in .ts file: " << msg.tsLineNumber() << std::endl;
+        out << "* Line in .ts file: " << msg.tsLineNumber() << std::endl;
         for (int tsLineNumber : dups) {
             if (tsLineNumber >= 0)
-                std::cerr << "* Duplicate at line: " << tsLineNumber << std::endl;
+                out << "* Duplicate at line: " << tsLineNumber << std::endl;
         }
     }
 }
@@ -659,6 +977,8 @@ void Translator::makeFileNamesAbsolute(const QDir &originalPath)
             msg.addReference(fileName, ref.lineNumber());
         }
     }
+    m_fileIdxOk = false;
+    m_refIdxOk = false;
 }
 
 const QList<TranslatorMessage> &Translator::messages() const
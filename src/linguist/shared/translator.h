@@ -17,6 +17,8 @@
 #include <QSet>
 #include <QVector>
 
+#include <iosfwd>
+
 QT_BEGIN_NAMESPACE
 
 class QIODevice;
@@ -71,18 +73,38 @@ public:
     QStringList m_rootDirs;
 };
 
+// The hash is computed once, as QHash hashes all keys again when it grows.
 class TMMKey {
 public:
     TMMKey(const TranslatorMessage &msg)
-        { context = msg.context(); source = msg.sourceText(); comment = msg.comment(); }
+        : context(msg.context()), source(msg.sourceText()), comment(msg.comment()),
+          hash(qHashMulti(0, context, source, comment)) {}
     bool operator==(const TMMKey &o) const
-        { return context == o.context && source == o.source && comment == o.comment; }
+        { return hash == o.hash && context == o.context && source == o.source
+                 && comment == o.comment; }
     QString context, source, comment;
+    size_t hash;
 };
 Q_DECLARE_TYPEINFO(TMMKey, Q_RELOCATABLE_TYPE);
-inline size_t qHash(const TMMKey &key)
+inline size_t qHash(const TMMKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.hash);
+}
+
+class TMMRefKey {
+public:
+    TMMRefKey(const QString &ctx, const QString &cmt, const TranslatorMessage::Reference &ref)
+        : context(ctx), comment(cmt), fileName(ref.fileName()), lineNumber(ref.lineNumber()) {}
+    bool operator==(const TMMRefKey &o) const
+        { return lineNumber == o.lineNumber && fileName == o.fileName && context == o.context
+                 && comment == o.comment; }
+    QString context, comment, fileName;
+    int lineNumber;
+};
+Q_DECLARE_TYPEINFO(TMMRefKey, Q_RELOCATABLE_TYPE);
+inline size_t qHash(const TMMRefKey &key)
 {
-    return qHash(key.context) ^ qHash(key.source) ^ qHash(key.comment);
+    return qHashMulti(0, key.context, key.comment, key.fileName, key.lineNumber);
 }
 
 class Translator
@@ -91,6 +113,9 @@ public:
     Translator();
 
     bool load(const QString &filename, ConversionData &err, const QString &format /* = "auto" */);
+    // Reads from the already opened dev; filename is used to guess the format.
+    bool load(QIODevice &dev, const QString &filename, ConversionData &err,
+              const QString &format /* = "auto" */);
     bool save(const QString &filename, ConversionData &err, const QString &format /* = "auto" */) const;
 
     int find(const TranslatorMessage &msg) const;
@@ -98,9 +123,17 @@ public:
         const QString &comment, const TranslatorMessage::References &refs) const;
 
     int find(const QString &context) const;
+    // Builds the indexes that the find() overloads otherwise build on first
+    // use, so that they can be called from several threads at once.
+    void buildIndexes() const { ensureIndexed(); ensureRefIndexed(); ensureRows(); }
 
     void replaceSorted(const TranslatorMessage &msg);
+    // Like replaceSorted() for each message, but without moving the existing
+    // messages for every insertion.
+    void replaceSorted(const QList<TranslatorMessage> &messages);
     void extend(const TranslatorMessage &msg, ConversionData &cd); // Only for single-location messages
+    // Makes extend() also append the messages it accepts to messages, as they were passed.
+    void setExtendLog(QList<TranslatorMessage> *messages) { m_extendLog = messages; }
     void append(const TranslatorMessage &msg);
     void appendSorted(const TranslatorMessage &msg);
 
@@ -122,8 +155,11 @@ public:
     };
     Duplicates resolveDuplicates();
     void reportDuplicates(const Duplicates &dupes, const QString &fileName, bool verbose);
+    void reportDuplicates(const Duplicates &dupes, const QString &fileName, bool verbose,
+                          std::ostream &out);
     void reportDuplicatesLines(const TranslatorMessage &msg,
-                               const DuplicateEntries::value_type &dups) const;
+                               const DuplicateEntries::value_type &dups,
+                               std::ostream &out) const;
 
     QString languageCode() const { return m_language; }
     QString sourceLanguageCode() const { return m_sourceLanguage; }
@@ -144,7 +180,10 @@ public:
     QStringList normalizedTranslations(const TranslatorMessage &m, ConversionData &cd, bool *ok) const;
 
     int messageCount() const { return m_messages.size(); }
-    TranslatorMessage &message(int i) { return m_messages[i]; }
+    // Messages are only modified through methods that keep the indexes up to date.
+    // The translations are not indexed.
+    void setTranslations(int i, const QStringList &translations)
+    { m_messages[i].setTranslations(translations); }
     const TranslatorMessage &message(int i) const { return m_messages.at(i); }
     const TranslatorMessage &constMessage(int i) const { return m_messages.at(i); }
     void dump() const;
@@ -184,9 +223,25 @@ public:
 
 private:
     void insert(int idx, const TranslatorMessage &msg);
-    void addIndex(int idx, const TranslatorMessage &msg) const;
+    void ensureIds() const;
+    void ensureRows() const;
+    int rowOf(int id) const { ensureRows(); return id < 0 ? -1 : m_rows.at(id); }
+    void addIndex(int id, const TranslatorMessage &msg) const;
     void delIndex(int idx) const;
     void ensureIndexed() const;
+    void addFileIndex(int id, const TranslatorMessage &msg) const;
+    void delFileIndex(int idx) const;
+    void ensureFileIndexed() const;
+    void addRefIndex(int id, const TranslatorMessage &msg) const;
+    void delRefIndex(int idx) const;
+    void ensureRefIndexed() const;
+    void invalidateIndexes()
+    {
+        m_indexOk = false;
+        m_fileIdxOk = false;
+        m_refIdxOk = false;
+        m_idsOk = false;
+    }
 
     typedef QList<TranslatorMessage> TMM;       // int stores the sequence position.
 
@@ -206,11 +261,28 @@ private:
     QString m_sourceLanguage;
     QStringList m_dependencies;
     ExtraData m_extra;
+    QList<TranslatorMessage> *m_extendLog = nullptr;
+
+    // The indexes refer to the messages by an id that stays the same when
+    // messages are inserted in front of them, so that an insertion does not
+    // need to update them. The ids are only kept while there are indexes.
+    mutable bool m_idsOk = true;
+    mutable QList<int> m_ids; // The id of the message in each row
+    mutable QList<int> m_rows; // The row of each id, up to date below m_rowsDirtyFrom
+    mutable qsizetype m_rowsDirtyFrom = 0;
 
     mutable bool m_indexOk;
     mutable QHash<QString, int> m_ctxCmtIdx;
     mutable QHash<QString, int> m_idMsgIdx;
     mutable QHash<TMMKey, int> m_msgIdx;
+    // The ids of the messages of each (file name, context) pair in row order,
+    // for appendSorted(). Only built once it is needed.
+    mutable bool m_fileIdxOk = false;
+    mutable QHash<std::pair<QString, QString>, QList<int>> m_fileIdx;
+    // The ids of the messages with each context, comment and reference,
+    // for find(context, comment, refs). Only built once it is needed.
+    mutable bool m_refIdxOk = false;
+    mutable QHash<TMMRefKey, QList<int>> m_refIdx;
 };
 
 bool getNumerusInfo(QLocale::Language language, QLocale::Territory territory, QByteArray *rules,
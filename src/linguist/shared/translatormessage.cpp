@@ -23,27 +23,70 @@ TranslatorMessage::TranslatorMessage(const QString &context,
     const QString &userData,
     const QString &fileName, int lineNumber, const QStringList &translations,
     Type type, bool plural)
-  : m_context(context), m_sourcetext(sourceText), m_comment(comment),
+  : m_context(internedString(context)), m_sourcetext(sourceText), m_comment(comment),
     m_userData(userData),
-    m_translations(translations), m_fileName(fileName), m_lineNumber(lineNumber),
-    m_type(type), m_plural(plural)
+    m_translations(translations), m_fileName(internedString(fileName)),
+    m_lineNumber(lineNumber), m_type(type), m_plural(plural)
 {
 }
 
+static thread_local QSet<QString> *internPool = nullptr;
+
+TranslatorMessage::InternScope::InternScope()
+    : m_owner(!internPool)
+{
+    if (m_owner)
+        internPool = &m_pool;
+}
+
+TranslatorMessage::InternScope::~InternScope()
+{
+    if (m_owner)
+        internPool = nullptr;
+}
+
+/*
+ * Returns a string that is equal to str and shares its data with the strings
+ * returned for all other equal strings in the current InternScope. The same
+ * few contexts and file names appear in thousands of messages, so interning
+ * them keeps a single copy of each instead of one per message or reference.
+ *
+ * Without a scope on the calling thread, str is returned as it is.
+ */
+QString TranslatorMessage::internedString(const QString &str)
+{
+    if (!internPool || str.isEmpty())
+        return str;
+    auto it = internPool->constFind(str);
+    if (it == internPool->cend())
+        it = internPool->insert(str);
+    return *it;
+}
+
+void TranslatorMessage::setContext(const QString &context)
+{
+    m_context = internedString(context);
+}
+
+void TranslatorMessage::setFileName(const QString &fileName)
+{
+    m_fileName = internedString(fileName);
+}
+
 void TranslatorMessage::addReference(const QString &fileName, int lineNumber)
 {
     if (m_fileName.isEmpty()) {
-        m_fileName = fileName;
+        m_fileName = internedString(fileName);
         m_lineNumber = lineNumber;
     } else {
-        m_extraRefs.append(Reference(fileName, lineNumber));
+        m_extraRefs.append(Reference(internedString(fileName), lineNumber));
     }
 }
 
 void TranslatorMessage::addReferenceUniq(const QString &fileName, int lineNumber)
 {
     if (m_fileName.isEmpty()) {
-        m_fileName = fileName;
+        m_fileName = internedString(fileName);
         m_lineNumber = lineNumber;
     } else {
         if (fileName == m_fileName && lineNumber == m_lineNumber)
@@ -54,7 +97,7 @@ void TranslatorMessage::addReferenceUniq(const QString &fileName, int lineNumber
                     return;
             }
         }
-        m_extraRefs.append(Reference(fileName, lineNumber));
+        m_extraRefs.append(Reference(internedString(fileName), lineNumber));
     }
 }
 
@@ -68,11 +111,13 @@ void TranslatorMessage::clearReferences()
 void TranslatorMessage::setReferences(const TranslatorMessage::References &refs0)
 {
     if (!refs0.isEmpty()) {
-        References refs = refs0;
-        const Reference &ref = refs.takeFirst();
-        m_fileName = ref.fileName();
-        m_lineNumber = ref.lineNumber();
-        m_extraRefs = refs;
+        m_fileName = internedString(refs0.first().fileName());
+        m_lineNumber = refs0.first().lineNumber();
+        m_extraRefs.clear();
+        m_extraRefs.reserve(refs0.size() - 1);
+        for (qsizetype i = 1; i < refs0.size(); ++i)
+            m_extraRefs.append(Reference(internedString(refs0.at(i).fileName()),
+                                         refs0.at(i).lineNumber()));
     } else {
         clearReferences();
     }
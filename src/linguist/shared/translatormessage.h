@@ -7,6 +7,7 @@
 #include <QString>
 #include <QStringList>
 #include <QHash>
+#include <QSet>
 
 
 QT_BEGIN_NAMESPACE
@@ -44,7 +45,7 @@ public:
     void setId(const QString &id) { m_id = id; }
 
     QString context() const { return m_context; }
-    void setContext(const QString &context) { m_context = context; }
+    void setContext(const QString &context);
 
     QString sourceText() const { return m_sourcetext; }
     void setSourceText(const QString &sourcetext) { m_sourcetext = sourcetext; }
@@ -70,7 +71,7 @@ public:
     }
 
     QString fileName() const { return m_fileName; }
-    void setFileName(const QString &fileName) { m_fileName = fileName; }
+    void setFileName(const QString &fileName);
     int lineNumber() const { return m_lineNumber; }
     void setLineNumber(int lineNumber) { m_lineNumber = lineNumber; }
     int tsLineNumber() const { return m_tsLineNumber; }
@@ -113,6 +114,22 @@ public:
 
     void dump() const;
 
+    // While an InternScope exists, the contexts and file names of the messages
+    // created on the same thread are interned, so that equal strings share one
+    // copy. The pool is released with the outermost scope.
+    class InternScope
+    {
+    public:
+        InternScope();
+        ~InternScope();
+    private:
+        Q_DISABLE_COPY_MOVE(InternScope)
+        QSet<QString> m_pool;
+        bool m_owner;
+    };
+
+    static QString internedString(const QString &str);
+
 private:
     QString     m_id;
     QString     m_context;
@@ -6,7 +6,7 @@
 #include <QtCore/QByteArray>
 #include <QtCore/QDebug>
 #include <QtCore/QRegularExpression>
-#include <QtCore/QTextStream>
+#include <QtCore/QStringEncoder>
 
 #include <QtCore/QXmlStreamReader>
 
@@ -404,62 +404,151 @@ bool TSReader::read(Translator &translator)
     return true;
 }
 
-static QString tsNumericEntity(int ch)
+namespace {
+
+// A string that is escaped when it is written to a TSWriter.
+struct TSProtected
+{
+    QStringView str;
+};
+
+/*
+    Writes a TS file as UTF-8 into a buffer, which goes to the device in
+    big chunks. Protected strings are escaped straight into the buffer, and
+    the runs between the characters that need escaping are encoded at once.
+*/
+class TSWriter
 {
-    return QString(ch <= 0x20 ? QLatin1String("<byte value=\"x%1\"/>")
-        : QLatin1String("&#x%1;")) .arg(ch, 0, 16);
+public:
+    explicit TSWriter(QIODevice &dev) : m_dev(dev) { m_buffer.reserve(ChunkSize + ChunkSize / 8); }
+
+    TSWriter &operator<<(const char *str)
+    {
+        m_buffer.append(str);
+        return maybeFlush();
+    }
+    TSWriter &operator<<(QStringView str)
+    {
+        appendUtf8(str);
+        return maybeFlush();
+    }
+    TSWriter &operator<<(TSProtected str);
+
+    bool flush();
+
+private:
+    enum { ChunkSize = 1 << 20 };
+
+    void appendUtf8(QStringView str);
+    void appendEntity(char16_t ch);
+    TSWriter &maybeFlush()
+    {
+        if (m_buffer.size() >= ChunkSize)
+            flush();
+        return *this;
+    }
+
+    QIODevice &m_dev;
+    QByteArray m_buffer;
+    QStringEncoder m_encoder { QStringEncoder::Utf8, QStringEncoder::Flag::Stateless };
+    bool m_ok = true;
+};
+
 }
 
-static QString tsProtect(const QString &str)
+static TSProtected tsProtect(QStringView str)
 {
-    QString result;
-    result.reserve(str.size() * 12 / 10);
-    for (int i = 0; i != str.size(); ++i) {
-        const QChar ch = str[i];
-        uint c = ch.unicode();
-        switch (c) {
-        case '\"':
-            result += QLatin1String("&quot;");
-            break;
-        case '&':
-            result += QLatin1String("&amp;");
-            break;
-        case '>':
-            result += QLatin1String("&gt;");
-            break;
-        case '<':
-            result += QLatin1String("&lt;");
-            break;
-        case '\'':
-            result += QLatin1String("&apos;");
-            break;
-        default:
-            if ((c < 0x20 || (ch > QChar(0x7f) && ch.isSpace())) && c != '\n' && c != '\t')
-                result += tsNumericEntity(c);
-            else // this also covers surrogates
-                result += QChar(c);
+    return { str };
+}
+
+static bool tsNeedsEscape(char16_t ch)
+{
+    if (ch < 0x80) {
+        if (ch < 0x20)
+            return ch != '\n' && ch != '\t';
+        return ch == '\"' || ch == '&' || ch == '>' || ch == '<' || ch == '\'';
+    }
+    return QChar::isSpace(ch); // surrogates are not, so pairs are kept intact
+}
+
+void TSWriter::appendUtf8(QStringView str)
+{
+    if (str.isEmpty())
+        return;
+    const qsizetype size = m_buffer.size();
+    m_buffer.resize(size + m_encoder.requiredSpace(str.size()));
+    char *end = m_encoder.appendToBuffer(m_buffer.data() + size, str);
+    m_buffer.truncate(end - m_buffer.constData());
+}
+
+void TSWriter::appendEntity(char16_t ch)
+{
+    switch (ch) {
+    case '\"':
+        m_buffer.append("&quot;");
+        break;
+    case '&':
+        m_buffer.append("&amp;");
+        break;
+    case '>':
+        m_buffer.append("&gt;");
+        break;
+    case '<':
+        m_buffer.append("&lt;");
+        break;
+    case '\'':
+        m_buffer.append("&apos;");
+        break;
+    default:
+        if (ch <= 0x20)
+            m_buffer.append("<byte value=\"x").append(QByteArray::number(ch, 16)).append("\"/>");
+        else
+            m_buffer.append("&#x").append(QByteArray::number(ch, 16)).append(';');
+    }
+}
+
+TSWriter &TSWriter::operator<<(TSProtected str)
+{
+    const char16_t *run = str.str.utf16();
+    const char16_t *end = run + str.str.size();
+    for (const char16_t *it = run; it != end; ++it) {
+        if (tsNeedsEscape(*it)) {
+            appendUtf8(QStringView(run, it));
+            appendEntity(*it);
+            run = it + 1;
         }
     }
-    return result;
+    appendUtf8(QStringView(run, end));
+    return maybeFlush();
 }
 
-static void writeExtras(QTextStream &t, const char *indent,
+bool TSWriter::flush()
+{
+    if (!m_buffer.isEmpty()) {
+        if (m_dev.write(m_buffer) != m_buffer.size())
+            m_ok = false;
+        m_buffer.resize(0); // keeps the capacity, unlike clear()
+    }
+    return m_ok;
+}
+
+static void writeExtras(TSWriter &t, const char *indent,
                         const TranslatorMessage::ExtraData &extras, QRegularExpression drops)
 {
-    QStringList outs;
+    // Sorted as the tags they are written as
+    QStringList tags;
     for (auto it = extras.cbegin(), end = extras.cend(); it != end; ++it) {
-        if (!drops.match(it.key()).hasMatch()) {
-            outs << (QStringLiteral("<extra-") + it.key() + QLatin1Char('>')
-                     + tsProtect(it.value())
-                     + QStringLiteral("</extra-") + it.key() + QLatin1Char('>'));
-        }
+        if (!drops.match(it.key()).hasMatch())
+            tags << it.key() + QLatin1Char('>');
+    }
+    tags.sort();
+    for (const QString &tag : std::as_const(tags)) {
+        t << indent << "<extra-" << tag << tsProtect(extras.value(tag.chopped(1)))
+          << "</extra-" << tag << "\n";
     }
-    outs.sort();
-    for (const QString &out : std::as_const(outs))
-        t << indent << out << Qt::endl;
 }
 
-static void writeVariants(QTextStream &t, const char *indent, const QString &input)
+static void writeVariants(TSWriter &t, const char *indent, const QString &input)
 {
     int offset;
     if ((offset = input.indexOf(Translator::BinaryVariantSeparator)) >= 0) {
@@ -467,7 +556,7 @@ static void writeVariants(QTextStream &t, const char *indent, const QString &inp
         int start = 0;
         forever {
             t << "\n    " << indent << "<lengthvariant>"
-              << tsProtect(input.mid(start, offset - start))
+              << tsProtect(QStringView(input).sliced(start, offset - start))
               << "</lengthvariant>";
             if (offset == input.size())
                 break;
@@ -484,8 +573,7 @@ static void writeVariants(QTextStream &t, const char *indent, const QString &inp
 
 bool saveTS(const Translator &translator, QIODevice &dev, ConversionData &cd)
 {
-    bool result = true;
-    QTextStream t(&dev);
+    TSWriter t(dev);
 
     // The xml prolog allows processors to easily detect the correct encoding
     t << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<!DOCTYPE TS>\n";
@@ -512,7 +600,8 @@ bool saveTS(const Translator &translator, QIODevice &dev, ConversionData &cd)
 
     writeExtras(t, "    ", translator.extras(), drops);
 
-    QHash<QString, QList<TranslatorMessage> > messageOrder;
+    // The messages are grouped by pointer, so that saving does not copy them
+    QHash<QString, QList<const TranslatorMessage *> > messageOrder;
     QList<QString> contextOrder;
     for (const TranslatorMessage &msg : translator.messages()) {
         // no need for such noise
@@ -521,10 +610,10 @@ bool saveTS(const Translator &translator, QIODevice &dev, ConversionData &cd)
             continue;
         }
 
-        QList<TranslatorMessage> &context = messageOrder[msg.context()];
+        QList<const TranslatorMessage *> &context = messageOrder[msg.context()];
         if (context.isEmpty())
             contextOrder.append(msg.context());
-        context.append(msg);
+        context.append(&msg);
     }
     if (cd.sortContexts())
         std::sort(contextOrder.begin(), contextOrder.end());
@@ -536,7 +625,8 @@ bool saveTS(const Translator &translator, QIODevice &dev, ConversionData &cd)
              "    <name>"
           << tsProtect(context)
           << "</name>\n";
-        for (const TranslatorMessage &msg : std::as_const(messageOrder[context])) {
+        for (const TranslatorMessage *message : std::as_const(messageOrder[context])) {
+            const TranslatorMessage &msg = *message;
             //msg.dump();
 
                 t << "    <message";
@@ -638,7 +728,7 @@ bool saveTS(const Translator &translator, QIODevice &dev, ConversionData &cd)
     }
 
     t << "</TS>\n";
-    return result;
+    return t.flush();
 }
 
 bool loadTS(Translator &translator, QIODevice &dev, ConversionData &cd)
@@ -743,20 +743,20 @@ bool saveXLIFF(const Translator &translator, QIODevice &dev, ConversionData &cd)
     dtgs << QLatin1String("po-(old_)?msgid_plural");
     QRegularExpression drops(QRegularExpression::anchoredPattern(dtgs.join(QLatin1Char('|'))));
 
-    QHash<QString, QHash<QString, QList<TranslatorMessage> > > messageOrder;
+    QHash<QString, QHash<QString, QList<const TranslatorMessage *> > > messageOrder;
     QHash<QString, QList<QString> > contextOrder;
     QList<QString> fileOrder;
     for (const TranslatorMessage &msg : translator.messages()) {
         QString fn = msg.fileName();
         if (fn.isEmpty() && msg.type() == TranslatorMessage::Obsolete)
             fn = QLatin1String(MAGIC_OBSOLETE_REFERENCE);
-        QHash<QString, QList<TranslatorMessage> > &file = messageOrder[fn];
+        QHash<QString, QList<const TranslatorMessage *> > &file = messageOrder[fn];
         if (file.isEmpty())
             fileOrder.append(fn);
-        QList<TranslatorMessage> &context = file[msg.context()];
+        QList<const TranslatorMessage *> &context = file[msg.context()];
         if (context.isEmpty())
             contextOrder[fn].append(msg.context());
-        context.append(msg);
+        context.append(&msg);
     }
 
     ts.setFieldAlignment(QTextStream::AlignRight);
@@ -776,7 +776,7 @@ bool saveXLIFF(const Translator &translator, QIODevice &dev, ConversionData &cd)
     for (const QString &fn : std::as_const(fileOrder)) {
         writeIndent(ts, indent);
         ts << "<file original=\"" << fn << "\""
-            << " datatype=\"" << dataType(messageOrder[fn].cbegin()->first()) << "\""
+            << " datatype=\"" << dataType(*messageOrder[fn].cbegin()->first()) << "\""
             << " source-language=\"" << sourceLanguageCode.toLatin1() << "\""
             << " target-language=\"" << languageCode.toLatin1() << "\""
             << "><body>\n";
@@ -790,8 +790,8 @@ bool saveXLIFF(const Translator &translator, QIODevice &dev, ConversionData &cd)
                 ++indent;
             }
 
-            for (const TranslatorMessage &msg : std::as_const(messageOrder[fn][ctx]))
-                writeMessage(ts, msg, drops, indent);
+            for (const TranslatorMessage *msg : std::as_const(messageOrder[fn][ctx]))
+                writeMessage(ts, *msg, drops, indent);
 
             if (!ctx.isEmpty()) {
                 --indent;
@@ -4,6 +4,8 @@
 #include "config.h"
 #include "utilities.h"
 
+#include "filesystem/filecopier.h"
+
 #include <QtCore/qdir.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qtemporaryfile.h>
@@ -63,6 +65,7 @@ QString ConfigStrings::OUTPUTDIR = QStringLiteral("outputdir");
 QString ConfigStrings::OUTPUTFORMATS = QStringLiteral("outputformats");
 QString ConfigStrings::OUTPUTPREFIXES = QStringLiteral("outputprefixes");
 QString ConfigStrings::OUTPUTSUFFIXES = QStringLiteral("outputsuffixes");
+QString ConfigStrings::PRECOMPRESS = QStringLiteral("precompress");
 QString ConfigStrings::PRODUCTNAME QStringLiteral("productname");
 QString ConfigStrings::PROJECT = QStringLiteral("project");
 QString ConfigStrings::REDIRECTDOCUMENTATIONTODEVNULL =
@@ -941,6 +944,11 @@ QString Config::findFile(const Location &location, const QStringList &files,
   \a userFriendlySourceFilePath. \a location is for identifying
   the file and line number where a qdoc error occurred. The
   constructed output file name is returned.
+
+  The copy itself is performed in the background by FileCopier,
+  which skips targets that were already copied, or are up to date
+  from a previous run. Errors that happen while copying are
+  reported when the generator terminates.
  */
 QString Config::copyFile(const Location &location, const QString &sourceFilePath,
                          const QString &userFriendlySourceFilePath, const QString &targetDirPath)
@@ -954,10 +962,10 @@ QString Config::copyFile(const Location &location, const QString &sourceFilePath
     // copying files into an appropriate subsystem and have a better
     // understanding of call-site usages.
 
-    QFile inFile(sourceFilePath);
-    if (!inFile.open(QFile::ReadOnly)) {
-        location.warning(QStringLiteral("Cannot open input file for copy: '%1': %2")
-                                 .arg(sourceFilePath, inFile.errorString()));
+    QFileInfo inFileInfo(sourceFilePath);
+    if (!inFileInfo.isFile() || !inFileInfo.isReadable()) {
+        location.warning(QStringLiteral("Cannot open input file for copy: '%1'")
+                                 .arg(sourceFilePath));
         return QString();
     }
 
@@ -1002,27 +1010,14 @@ QString Config::copyFile(const Location &location, const QString &sourceFilePath
 
     outFileName = targetDirPath + "/" + outFileName;
     QDir targetDir(targetDirPath);
-    if (!targetDir.exists())
-        targetDir.mkpath(".");
-
-    QFile outFile(outFileName);
-    if (!outFile.open(QFile::WriteOnly)) {
+    if (!targetDir.exists() && !targetDir.mkpath(".")) {
         // TODO: [uncrentralized-warning]
-        location.warning(QStringLiteral("Cannot open output file for copy: '%1': %2")
-                                 .arg(outFileName, outFile.errorString()));
+        location.warning(QStringLiteral("Cannot create output directory for copy: '%1'")
+                                 .arg(targetDirPath));
         return QString();
     }
 
-    // TODO: There shouldn't be any particular advantage to copying
-    // the file by readying its content and writing it compared to
-    // asking the underlying system to do the copy for us.
-    // Consider simplifying this part by avoiding doing the manual
-    // work ourselves.
-
-    char buffer[1024];
-    qsizetype len;
-    while ((len = inFile.read(buffer, sizeof(buffer))) > 0)
-        outFile.write(buffer, len);
+    FileCopier::instance().copy(sourceFilePath, outFileName);
     return outFileName;
 }
 
@@ -2940,8 +2940,7 @@ void DocBookGenerator::generateAlsoList(const Node *node)
 QXmlStreamWriter *DocBookGenerator::startGenericDocument(const Node *node, const QString &fileName)
 {
     Q_ASSERT(node->isPageNode());
-    QFile *outFile = openSubPageFile(static_cast<const PageNode*>(node), fileName);
-    m_writer = new QXmlStreamWriter(outFile);
+    m_writer = new QXmlStreamWriter(openPageDevice(static_cast<const PageNode*>(node), fileName));
     m_writer->setAutoFormatting(false); // We need a precise handling of line feeds.
 
     m_writer->writeStartDocument();
@@ -2986,8 +2985,7 @@ void DocBookGenerator::endDocument()
     m_writer->writeEndElement(); // article
     m_writer->writeEndDocument();
 
-    m_writer->device()->close();
-    delete m_writer->device();
+    closePageDevice(m_writer->device());
     delete m_writer;
     m_writer = nullptr;
 }
@@ -3048,8 +3046,8 @@ void DocBookGenerator::generateCppReferencePage(Node *node)
         endSection();
     }
 
-    Sections sections(const_cast<Aggregate *>(aggregate));
-    SectionVector sectionVector =
+    const Sections &sections = Sections::forAggregate(const_cast<Aggregate *>(aggregate));
+    const SectionVector &sectionVector =
             (aggregate->isNamespace() || aggregate->isHeader()) ?
                     sections.stdDetailsSections() :
                     sections.stdCppClassDetailsSections();
@@ -4349,7 +4347,7 @@ void DocBookGenerator::generateQmlTypePage(QmlTypeNode *qcn)
 
     endSection();
 
-    Sections sections(qcn);
+    const Sections &sections = Sections::forAggregate(qcn);
     for (const auto &section : sections.stdQmlTypeDetailsSections()) {
         if (!section.isEmpty()) {
             startSection(section.title().toLower(), section.title());
@@ -4585,8 +4583,8 @@ void DocBookGenerator::generateProxyPage(Aggregate *aggregate)
         endSection();
     }
 
-    Sections sections(aggregate);
-    SectionVector *detailsSections = &sections.stdDetailsSections();
+    const Sections &sections = Sections::forAggregate(aggregate);
+    const SectionVector *detailsSections = &sections.stdDetailsSections();
 
     for (const auto &section : std::as_const(*detailsSections)) {
         if (section.isEmpty())
@@ -0,0 +1,136 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "filecopier.h"
+
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+
+#include <utility>
+
+/*!
+ * \class FileCopier
+ * \internal
+ * \brief Copies files into the output directory, such as images and
+ * template files, without blocking the generation of pages.
+ *
+ * Every use of an image in the documentation requests a copy of the
+ * image into the output directory, so that the same file is usually
+ * requested many times.
+ * A FileCopier remembers the targets it was asked to produce and
+ * ignores a request for a target that it has already copied from the
+ * same source.
+ *
+ * Copies are performed on a thread pool.
+ * A copy is skipped when the target already exists with the same size
+ * as the source and is not older than it, as is the case when the
+ * output of a previous run is being regenerated.
+ * Otherwise, the file is copied with QFile::copy(), which lets the
+ * platform clone the file or copy it inside the kernel, for example
+ * with reflinks or \c copy_file_range on Linux, where available,
+ * instead of passing its content through a userspace buffer.
+ *
+ * Errors that happen during a copy are collected and returned by
+ * wait_for_done().
+ * Either that or wait_for_pending_copies() must be called before the
+ * copied files are read.
+ */
+
+/*!
+ * Waits for the pending copies to complete before destroying the
+ * instance.
+ */
+FileCopier::~FileCopier()
+{
+    pool.waitForDone();
+}
+
+/*!
+ * Schedules a copy of the file at \a source to \a target, whose
+ * directory must exist.
+ *
+ * Returns \c false, without scheduling anything, if \a target was
+ * already requested from \a source since the last call to
+ * wait_for_done(), and \c true otherwise.
+ *
+ * If \a target was requested from a different source, the pending
+ * copies are completed first, so that the last request wins, as it
+ * would if the files were copied synchronously.
+ */
+bool FileCopier::copy(const QString& source, const QString& target)
+{
+    auto requested = requested_targets.constFind(target);
+    if (requested != requested_targets.constEnd()) {
+        if (*requested == source)
+            return false;
+        pool.waitForDone();
+    }
+
+    requested_targets.insert(target, source);
+    pool.start([this, source, target]() { copy_now(source, target); });
+    return true;
+}
+
+/*!
+ * Blocks until all scheduled copies are completed, for users that
+ * need to read the copied files.
+ * Unlike wait_for_done(), the requested targets and the errors are
+ * kept.
+ */
+void FileCopier::wait_for_pending_copies()
+{
+    pool.waitForDone();
+}
+
+/*!
+ * Blocks until all scheduled copies are completed and forgets the
+ * targets that were requested.
+ * Returns the messages of the errors that happened since the last
+ * call.
+ */
+QStringList FileCopier::wait_for_done()
+{
+    pool.waitForDone();
+    requested_targets.clear();
+
+    QMutexLocker locker{&errors_mutex};
+    return std::exchange(errors, {});
+}
+
+/*!
+ * Returns \c true if \a target is the same file as \a source, or
+ * if it exists, has the same size as \a source and was not modified
+ * before \a source was.
+ */
+bool FileCopier::is_up_to_date(const QString& source, const QString& target)
+{
+    QFileInfo source_info{source};
+    QFileInfo target_info{target};
+
+    if (source_info == target_info)
+        return true;
+
+    return target_info.exists() && target_info.size() == source_info.size() &&
+           target_info.lastModified() >= source_info.lastModified();
+}
+
+void FileCopier::copy_now(const QString& source, const QString& target)
+{
+    if (is_up_to_date(source, target))
+        return;
+
+    // QFile::copy() refuses to overwrite an existing file.
+    QFile::remove(target);
+
+    QFile source_file{source};
+    if (!source_file.copy(target)) {
+        QMutexLocker locker{&errors_mutex};
+        errors << QStringLiteral("Cannot copy '%1' to '%2': %3")
+                          .arg(source, target, source_file.errorString());
+        return;
+    }
+
+    // The copy keeps the permissions of the source, which may be
+    // read-only, while later runs must be able to replace it.
+    QFile::setPermissions(target, QFile::permissions(target) | QFile::WriteOwner | QFile::WriteUser);
+}
@@ -0,0 +1,33 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#pragma once
+
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qthreadpool.h>
+
+#include "qdoc/singleton.h"
+
+class FileCopier : public Singleton<FileCopier> {
+public:
+    FileCopier() = default;
+    ~FileCopier();
+
+    bool copy(const QString& source, const QString& target);
+    void wait_for_pending_copies();
+    QStringList wait_for_done();
+
+    [[nodiscard]] static bool is_up_to_date(const QString& source, const QString& target);
+
+private:
+    void copy_now(const QString& source, const QString& target);
+
+    QThreadPool pool{};
+    QHash<QString, QString> requested_targets{};
+
+    QMutex errors_mutex{};
+    QStringList errors{};
+};
@@ -17,16 +17,21 @@
 #include "functionnode.h"
 #include "node.h"
 #include "openedlist.h"
+#include "outputcompressor.h"
 #include "propertynode.h"
 #include "qdocdatabase.h"
 #include "qmltypenode.h"
 #include "qmlpropertynode.h"
 #include "quoter.h"
+#include "sections.h"
 #include "sharedcommentnode.h"
 #include "tokenizer.h"
 #include "typedefnode.h"
 #include "utilities.h"
 
+#include "filesystem/filecopier.h"
+
+#include <QtCore/qbuffer.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qdir.h>
 #include <QtCore/qregularexpression.h>
@@ -87,6 +92,7 @@ Generator::Generator(FileResolver& file_resolver)
 Generator::~Generator()
 {
     s_generators.removeAll(this);
+    delete m_outputCompressor;
 }
 
 void Generator::appendFullName(Text &text, const Node *apparentNode, const Node *relative,
@@ -220,6 +226,44 @@ QFile *Generator::openSubPageFile(const PageNode *node, const QString &fileName)
     return outFile;
 }
 
+/*!
+  Creates the file named \a fileName in the output directory and
+  returns the device that the page for \a node is written to.
+
+  If the generator keeps the contents of its pages, the device
+  buffers the page in memory until closePageDevice() is called.
+ */
+QIODevice *Generator::openPageDevice(const PageNode *node, const QString &fileName)
+{
+    QFile *outFile = openSubPageFile(node, fileName);
+    if (s_redirectDocumentationToDevNull || !keepsPageContents())
+        return outFile;
+
+    // Keep the page in memory, owned by the file, so that
+    // closePageDevice() can hand it over without reading it back.
+    outFile->setTextModeEnabled(false);
+    auto *buffer = new QBuffer(outFile);
+    buffer->open(QIODevice::WriteOnly | QIODevice::Text);
+    return buffer;
+}
+
+/*!
+  Closes and deletes the \a device returned by openPageDevice().
+  A buffered page is written to its file and passed to
+  pageCompleted() first.
+ */
+void Generator::closePageDevice(QIODevice *device)
+{
+    if (auto *buffer = qobject_cast<QBuffer *>(device)) {
+        auto *outFile = static_cast<QFile *>(buffer->parent());
+        outFile->write(buffer->data());
+        pageCompleted(outFile->fileName(), buffer->data());
+        device = outFile;
+    }
+    device->close();
+    delete device;
+}
+
 /*!
   Creates the file named \a fileName in the output directory.
   Attaches a QTextStream to the created file, which is written
@@ -228,8 +272,7 @@ QFile *Generator::openSubPageFile(const PageNode *node, const QString &fileName)
 void Generator::beginSubPage(const Node *node, const QString &fileName)
 {
     Q_ASSERT(node->isPageNode());
-    QFile *outFile = openSubPageFile(static_cast<const PageNode*>(node), fileName);
-    auto *out = new QTextStream(outFile);
+    auto *out = new QTextStream(openPageDevice(static_cast<const PageNode *>(node), fileName));
     outStreamStack.push(out);
 }
 
@@ -240,9 +283,24 @@ void Generator::beginSubPage(const Node *node, const QString &fileName)
  */
 void Generator::endSubPage()
 {
-    outStreamStack.top()->flush();
-    delete outStreamStack.top()->device();
-    delete outStreamStack.pop();
+    QTextStream *out = outStreamStack.pop();
+    out->flush();
+    closePageDevice(out->device());
+    delete out;
+}
+
+/*!
+  Called when the page written to \a filePath is complete, with
+  the \a contents of the page, if keepsPageContents() returned
+  \c true when the page was started.
+
+  The default implementation hands the page to the output
+  compressor, if precompression is enabled.
+ */
+void Generator::pageCompleted(const QString &filePath, const QByteArray &contents)
+{
+    if (m_outputCompressor)
+        m_outputCompressor->compress(filePath, contents);
 }
 
 QString Generator::fileBase(const Node *node) const
@@ -1842,6 +1900,22 @@ void Generator::initializeFormat()
     copyTemplateFiles(format() + Config::dot + CONFIG_SCRIPTS, "scripts");
     copyTemplateFiles(format() + Config::dot + CONFIG_EXTRAIMAGES, "images");
 
+    bool gzip = false;
+    const auto &precompress = config.get(format() + Config::dot + CONFIG_PRECOMPRESS);
+    for (const auto &encoding : precompress.asStringList()) {
+        if (encoding == "gzip"_L1)
+            gzip = true;
+        else
+            precompress.location().warning(
+                    QStringLiteral("Unsupported precompression format '%1'").arg(encoding));
+    }
+    if (gzip && !s_redirectDocumentationToDevNull) {
+        if (!m_outputCompressor)
+            m_outputCompressor = new OutputCompressor;
+    } else {
+        finishOutputCompression();
+    }
+
     // Use a format-specific .quotinginformation if defined, otherwise a global value
     if (config.subVars(format()).contains(CONFIG_QUOTINGINFORMATION))
         m_quoting = config.get(format() + Config::dot + CONFIG_QUOTINGINFORMATION).asBool();
@@ -1874,7 +1948,19 @@ QTextStream &Generator::out()
 
 QString Generator::outFileName()
 {
-    return QFileInfo(static_cast<QFile *>(out().device())->fileName()).fileName();
+    return QFileInfo(outFilePath()).fileName();
+}
+
+/*!
+  Returns the path of the file that the current output stream
+  writes to.
+ */
+QString Generator::outFilePath()
+{
+    QIODevice *device = out().device();
+    if (auto *buffer = qobject_cast<QBuffer *>(device))
+        device = static_cast<QIODevice *>(buffer->parent());
+    return static_cast<QFile *>(device)->fileName();
 }
 
 QString Generator::outputPrefix(const Node *node)
@@ -2139,9 +2225,33 @@ void Generator::terminate()
     s_fmtLeftMaps.clear();
     s_fmtRightMaps.clear();
     s_outDir.clear();
+    Sections::clearCache();
 }
 
-void Generator::terminateGenerator() {}
+void Generator::terminateGenerator()
+{
+    const QStringList copyErrors = FileCopier::instance().wait_for_done();
+    for (const auto &error : copyErrors)
+        Location().warning(error);
+
+    finishOutputCompression();
+}
+
+/*!
+  Waits for pending precompressed output to be written and
+  reports any errors that occurred while writing it.
+ */
+void Generator::finishOutputCompression()
+{
+    if (!m_outputCompressor)
+        return;
+
+    const QStringList errors = m_outputCompressor->waitForDone();
+    for (const auto &error : errors)
+        Location().warning(error);
+    delete m_outputCompressor;
+    m_outputCompressor = nullptr;
+}
 
 /*!
   Trims trailing whitespace off the \a string and returns
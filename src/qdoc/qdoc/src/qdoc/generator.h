@@ -25,6 +25,7 @@ class ExampleNode;
 class FunctionNode;
 class Location;
 class Node;
+class OutputCompressor;
 class QDocDatabase;
 
 class Generator
@@ -74,8 +75,12 @@ public:
 
 protected:
     static QFile *openSubPageFile(const PageNode *node, const QString &fileName);
+    QIODevice *openPageDevice(const PageNode *node, const QString &fileName);
+    void closePageDevice(QIODevice *device);
     void beginSubPage(const Node *node, const QString &fileName);
     void endSubPage();
+    [[nodiscard]] virtual bool keepsPageContents() const { return m_outputCompressor != nullptr; }
+    virtual void pageCompleted(const QString &filePath, const QByteArray &contents);
     [[nodiscard]] virtual QString fileExtension() const = 0;
     virtual void generateExampleFilePage(const Node *, ResolvedFile, CodeMarker * = nullptr) {}
     virtual void generateAlsoList(const Node *node, CodeMarker *marker);
@@ -132,6 +137,7 @@ protected:
     QString indent(int level, const QString &markedCode);
     QTextStream &out();
     QString outFileName();
+    QString outFilePath();
     bool parseArg(const QString &src, const QString &tag, int *pos, int n, QStringView *contents,
                   QStringView *par1 = nullptr);
     void unknownAtom(const Atom *atom);
@@ -189,11 +195,13 @@ private:
 
     void generateReimplementsClause(const FunctionNode *fn, CodeMarker *marker);
     static void copyTemplateFiles(const QString &configVar, const QString &subDir);
+    void finishOutputCompression();
 
 protected:
     FileResolver& file_resolver;
 
     QDocDatabase *m_qdb { nullptr };
+    OutputCompressor *m_outputCompressor { nullptr };
     bool m_inLink { false };
     bool m_inContents { false };
     bool m_inSectionHeading { false };
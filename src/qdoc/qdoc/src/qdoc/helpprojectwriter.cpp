@@ -16,7 +16,20 @@
 #include "qdocdatabase.h"
 #include "typedefnode.h"
 
+#include "filesystem/filecopier.h"
+
+#ifndef QDOC_NO_QCH
+#    include "qchwriter.h"
+#endif
+
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
 #include <QtCore/qhash.h>
+#include <QtCore/qregularexpression.h>
+
+#include <algorithm>
 
 QT_BEGIN_NAMESPACE
 
@@ -27,9 +40,16 @@ HelpProjectWriter::HelpProjectWriter(const QString &defaultFileName, Generator *
     reset(defaultFileName, g);
 }
 
+HelpProjectWriter::~HelpProjectWriter()
+{
+    clearQchWriters();
+}
+
 void HelpProjectWriter::reset(const QString &defaultFileName, Generator *g)
 {
+    clearQchWriters();
     m_projects.clear();
+    m_pageTitles.clear();
     m_gen = g;
     /*
       Get the pointer to the singleton for the qdoc database and
@@ -62,6 +82,16 @@ void HelpProjectWriter::reset(const QString &defaultFileName, Generator *g)
         project.m_indexRoot = config.get(prefix + "indexRoot").asString();
         project.m_filterAttributes = config.get(prefix + "filterAttributes").asStringSet();
         project.m_includeIndexNodes = config.get(prefix + "includeIndexNodes").asBool();
+        // Only the pages of the HTML generator are stored in a .qch file.
+        if (g->format() == "HTML"_L1)
+            project.m_qchFileName = config.get(prefix + "qchFile").asString();
+#ifdef QDOC_NO_QCH
+        if (!project.m_qchFileName.isEmpty()) {
+            config.location().warning(
+                    u"%1qchFile is not supported, QDoc was built without Qt SQL"_s.arg(prefix));
+            project.m_qchFileName.clear();
+        }
+#endif
         const QSet<QString> customFilterNames = config.subVars(prefix + "customFilters");
         for (const auto &filterName : customFilterNames) {
             QString name{config.get(prefix + "customFilters" + Config::dot + filterName
@@ -450,13 +480,37 @@ void HelpProjectWriter::generate()
         generateProject(project);
 }
 
-void HelpProjectWriter::writeSection(QXmlStreamWriter &writer, const QString &path,
-                                     const QString &value)
+void HelpProjectWriter::writeSection(HelpProject &project, QXmlStreamWriter &writer,
+                                     const QString &path, const QString &value)
+{
+    startSection(project, writer, path, value);
+    endSection(project, writer);
+}
+
+/*!
+    Opens a table of contents section for the page \a path, titled
+    \a value. If the \a project is written as a .qch file, the
+    section is also recorded in the binary format of the contents
+    table.
+ */
+void HelpProjectWriter::startSection(HelpProject &project, QXmlStreamWriter &writer,
+                                     const QString &path, const QString &value)
 {
     writer.writeStartElement(QStringLiteral("section"));
     writer.writeAttribute(QStringLiteral("ref"), path);
     writer.writeAttribute(QStringLiteral("title"), value);
+
+    if (!project.m_qchFileName.isEmpty()) {
+        QDataStream stream(&project.m_contents, QIODevice::WriteOnly | QIODevice::Append);
+        stream << project.m_sectionDepth << path << value;
+    }
+    ++project.m_sectionDepth;
+}
+
+void HelpProjectWriter::endSection(HelpProject &project, QXmlStreamWriter &writer)
+{
     writer.writeEndElement(); // section
+    --project.m_sectionDepth;
 }
 
 /*!
@@ -478,11 +532,11 @@ void HelpProjectWriter::addMembers(HelpProject &project, QXmlStreamWriter &write
     if (!node->isNamespace() && !node->isHeader() && !node->isQmlBasicType()
         && (derivedClass || node->isQmlType() || !project.m_memberStatus[node].isEmpty())) {
         QString membersPath = href + QStringLiteral("-members.html");
-        writeSection(writer, membersPath, QStringLiteral("List of all members"));
+        writeSection(project, writer, membersPath, QStringLiteral("List of all members"));
     }
     if (project.m_memberStatus[node].contains(Node::Deprecated)) {
         QString obsoletePath = href + QStringLiteral("-obsolete.html");
-        writeSection(writer, obsoletePath, QStringLiteral("Obsolete members"));
+        writeSection(project, writer, obsoletePath, QStringLiteral("Obsolete members"));
     }
 }
 
@@ -501,21 +555,20 @@ void HelpProjectWriter::writeNode(HelpProject &project, QXmlStreamWriter &writer
         QString typeStr = m_gen->typeString(node);
         if (!typeStr.isEmpty())
             typeStr[0] = typeStr[0].toTitleCase();
-        writer.writeStartElement("section");
-        writer.writeAttribute("ref", href);
         if (node->parent() && !node->parent()->name().isEmpty())
-            writer.writeAttribute("title",
-                                  QStringLiteral("%1::%2 %3 Reference")
-                                          .arg(node->parent()->name(), objName, typeStr));
+            startSection(project, writer, href,
+                         QStringLiteral("%1::%2 %3 Reference")
+                                 .arg(node->parent()->name(), objName, typeStr));
         else
-            writer.writeAttribute("title", QStringLiteral("%1 %2 Reference").arg(objName, typeStr));
+            startSection(project, writer, href,
+                         QStringLiteral("%1 %2 Reference").arg(objName, typeStr));
 
         addMembers(project, writer, node);
-        writer.writeEndElement(); // section
+        endSection(project, writer);
     } break;
 
     case Node::Namespace:
-        writeSection(writer, href, "%1 Namespace Reference"_L1.arg(objName));
+        writeSection(project, writer, href, "%1 Namespace Reference"_L1.arg(objName));
         break;
 
     case Node::Example:
@@ -524,12 +577,10 @@ void HelpProjectWriter::writeNode(HelpProject &project, QXmlStreamWriter &writer
     case Node::Group:
     case Node::Module:
     case Node::QmlModule: {
-        writer.writeStartElement("section");
-        writer.writeAttribute("ref", href);
-        writer.writeAttribute("title", node->fullTitle());
+        startSection(project, writer, href, node->fullTitle());
         if (node->nodeType() == Node::HeaderFile)
             addMembers(project, writer, node);
-        writer.writeEndElement(); // section
+        endSection(project, writer);
     } break;
     default:;
     }
@@ -553,6 +604,8 @@ void HelpProjectWriter::generateProject(HelpProject &project)
 
     project.m_files.clear();
     project.m_keywords.clear();
+    project.m_contents.clear();
+    project.m_sectionDepth = 0;
 
     QFile file(m_outputDir + QDir::separator() + project.m_fileName);
     if (!file.open(QFile::WriteOnly))
@@ -594,7 +647,6 @@ void HelpProjectWriter::generateProject(HelpProject &project)
         writer.writeTextElement("filterAttribute", filterName);
 
     writer.writeStartElement("toc");
-    writer.writeStartElement("section");
     const Node *node = m_qdb->findPageNodeByTitle(project.m_indexTitle);
     if (!node)
         node = m_qdb->findNodeByNameAndType(QStringList(project.m_indexTitle), &Node::isPageNode);
@@ -605,8 +657,7 @@ void HelpProjectWriter::generateProject(HelpProject &project)
         indexPath = m_gen->fullDocumentLocation(node);
     else
         indexPath = "index.html";
-    writer.writeAttribute("ref", indexPath);
-    writer.writeAttribute("title", project.m_indexTitle);
+    startSection(project, writer, indexPath, project.m_indexTitle);
 
     generateSections(project, writer, rootNode);
 
@@ -629,7 +680,7 @@ void HelpProjectWriter::generateProject(HelpProject &project)
                         break;
                     case Atom::ListRight:
                         if (sectionStack.pop() > 0)
-                            writer.writeEndElement(); // section
+                            endSection(project, writer);
                         break;
                     case Atom::ListItemLeft:
                         inItem = true;
@@ -640,13 +691,11 @@ void HelpProjectWriter::generateProject(HelpProject &project)
                     case Atom::Link:
                         if (inItem) {
                             if (sectionStack.top() > 0)
-                                writer.writeEndElement(); // section
+                                endSection(project, writer);
 
                             const Node *page = m_qdb->findNodeForTarget(atom->string(), nullptr);
-                            writer.writeStartElement("section");
                             QString indexPath = m_gen->fullDocumentLocation(page);
-                            writer.writeAttribute("ref", indexPath);
-                            writer.writeAttribute("title", atom->linkText());
+                            startSection(project, writer, indexPath, atom->linkText());
 
                             sectionStack.top() += 1;
                         }
@@ -664,14 +713,12 @@ void HelpProjectWriter::generateProject(HelpProject &project)
 
         } else {
 
-            writer.writeStartElement("section");
             QString indexPath = m_gen->fullDocumentLocation(
                     m_qdb->findNodeForTarget(subproject.m_indexTitle, nullptr));
             if (indexPath.isEmpty() && !subproject.m_indexTitle.isEmpty())
                 Config::instance().location().warning(
                         "Failed to find %1.indexTitle '%2'"_L1.arg(subproject.m_prefix, subproject.m_indexTitle));
-            writer.writeAttribute("ref", indexPath);
-            writer.writeAttribute("title", subproject.m_title);
+            startSection(project, writer, indexPath, subproject.m_title);
 
             if (subproject.m_sortPages) {
                 QStringList titles = subproject.m_nodes.keys();
@@ -716,14 +763,14 @@ void HelpProjectWriter::generateProject(HelpProject &project)
                 }
             }
 
-            writer.writeEndElement(); // section
+            endSection(project, writer);
         }
     }
 
     // Restore original search order
     m_qdb->setSearchOrder(searchOrder);
 
-    writer.writeEndElement(); // section
+    endSection(project, writer);
     writer.writeEndElement(); // toc
 
     writer.writeStartElement("keywords");
@@ -759,6 +806,259 @@ void HelpProjectWriter::generateProject(HelpProject &project)
     writer.writeEndElement(); // QtHelpProject
     writer.writeEndDocument();
     file.close();
+
+    if (!project.m_qchFileName.isEmpty())
+        generateQch(project, sortedFiles);
+}
+
+/*!
+    Returns \c true if any of the help projects is also written
+    directly as a .qch file, as set by \c {qhp.<project>.qchFile}.
+ */
+bool HelpProjectWriter::writesQch() const
+{
+    return std::any_of(m_projects.cbegin(), m_projects.cend(), [](const HelpProject &project) {
+        return !project.m_qchFileName.isEmpty();
+    });
+}
+
+/*
+    Returns the plain text of the HTML \a title, with tags removed and
+    character references decoded, as qhelpgenerator stores it.
+ */
+static QString plainTitle(QStringView title)
+{
+    static const QHash<QStringView, QChar> namedEntities = {
+        { u"amp", u'&' }, { u"lt", u'<' }, { u"gt", u'>' },
+        { u"quot", u'"' }, { u"apos", u'\'' }, { u"nbsp", u' ' },
+    };
+
+    QString text;
+    text.reserve(title.size());
+    for (qsizetype i = 0; i < title.size(); ++i) {
+        const QChar c = title.at(i);
+        if (c == u'<') {
+            const qsizetype end = title.indexOf(u'>', i);
+            if (end < 0)
+                break;
+            i = end;
+            continue;
+        }
+        const qsizetype end = c == u'&' ? title.indexOf(u';', i) : -1;
+        if (end < 0) {
+            text += c;
+            continue;
+        }
+        const QStringView name = title.sliced(i + 1, end - i - 1);
+        bool ok = false;
+        char32_t code = 0;
+        if (name.startsWith(u"#x") || name.startsWith(u"#X")) {
+            code = name.sliced(2).toUInt(&ok, 16);
+        } else if (name.startsWith(u'#')) {
+            code = name.sliced(1).toUInt(&ok, 10);
+        } else if (auto it = namedEntities.constFind(name); it != namedEntities.cend()) {
+            code = it->unicode();
+            ok = true;
+        }
+        if (!ok || !QChar::isPrint(code)) {
+            text += c;
+            continue;
+        }
+        text += QStringView(QChar::fromUcs4(code));
+        i = end;
+    }
+    return text.simplified();
+}
+
+/*!
+    Records \a title, the contents of the HTML <title> element, as the
+    document title of the page \a fileName, relative to the output
+    directory. The plain text of the title is stored with the page when
+    it is added with addPage().
+ */
+void HelpProjectWriter::setPageTitle(const QString &fileName, const QString &title)
+{
+    if (writesQch())
+        m_pageTitles.insert(fileName, plainTitle(title));
+}
+
+/*!
+    Adds the generated page \a fileName, relative to the output
+    directory, with the given \a contents to the .qch files of the
+    help projects that are written directly.
+
+    The generator calls this as soon as it finishes a page, so that
+    the page does not need to be read back from disk later.
+ */
+void HelpProjectWriter::addPage(const QString &fileName, const QByteArray &contents)
+{
+#ifndef QDOC_NO_QCH
+    QString title = m_pageTitles.take(fileName);
+    if (title.isEmpty())
+        title = fileName.mid(fileName.lastIndexOf(u'/') + 1);
+
+    for (HelpProject &project : m_projects) {
+        if (!project.m_qchFileName.isEmpty() && openQch(project))
+            project.m_qchWriter->addFile(fileName, title, contents);
+    }
+#else
+    Q_UNUSED(fileName);
+    Q_UNUSED(contents);
+#endif
+}
+
+/*!
+    Opens the .qch file of \a project, unless it is already open.
+    Returns \c false, after disabling the .qch output of the project,
+    if the file cannot be created.
+ */
+bool HelpProjectWriter::openQch(HelpProject &project)
+{
+#ifndef QDOC_NO_QCH
+    if (project.m_qchWriter)
+        return true;
+
+    QStringList filterAttributes = project.m_filterAttributes.values();
+    filterAttributes.sort();
+
+    auto *qch = new QchWriter;
+    if (!qch->open(QDir(m_outputDir).filePath(project.m_qchFileName), project.m_helpNamespace,
+                   project.m_virtualFolder, filterAttributes)) {
+        Config::instance().location().warning(qch->errorString());
+        delete qch;
+        project.m_qchFileName.clear();
+        return false;
+    }
+
+    qch->addMetaData(u"version"_s, project.m_version);
+    for (auto it = project.m_customFilters.cbegin(); it != project.m_customFilters.cend(); ++it) {
+        QStringList sortedAttributes = it.value().values();
+        sortedAttributes.sort();
+        qch->addCustomFilter(it.key(), sortedAttributes);
+    }
+
+    project.m_qchWriter = qch;
+    return true;
+#else
+    Q_UNUSED(project);
+    return false;
+#endif
+}
+
+#ifndef QDOC_NO_QCH
+/*
+    Returns the plain text of the <title> element in the HTML
+    document \a contents, or an empty string if there is none.
+ */
+static QString documentTitle(const QByteArray &contents)
+{
+    const qsizetype start = contents.indexOf("<title>");
+    const qsizetype end = contents.indexOf("</title>");
+    if (start < 0 || end < start + 7)
+        return {};
+    return plainTitle(QString::fromUtf8(contents.mid(start + 7, end - start - 7)));
+}
+
+/*
+    Returns the files matching \a pattern, relative to \a rootDir,
+    which may contain wildcards. A pattern that matches nothing is
+    returned as is, so that it is reported as missing.
+ */
+static QStringList matchingFiles(const QString &rootDir, const QString &pattern,
+                                 QHash<QString, QStringList> &dirEntries)
+{
+    if (!pattern.contains(u'?') && !pattern.contains(u'*') && !pattern.contains(u'['))
+        return { pattern };
+
+    const QFileInfo fileInfo(rootDir + u'/' + pattern);
+    const QString dirPath = fileInfo.dir().canonicalPath();
+    auto it = dirEntries.constFind(dirPath);
+    if (it == dirEntries.cend())
+        it = dirEntries.insert(dirPath, fileInfo.dir().entryList(QDir::Files));
+
+    const QRegularExpression re(QRegularExpression::wildcardToRegularExpression(fileInfo.fileName()));
+    const QString relativeDir = QFileInfo(pattern).dir().path();
+    QStringList matches;
+    for (const auto &entry : *it) {
+        if (re.match(entry).hasMatch())
+            matches << relativeDir + u'/' + entry;
+    }
+    if (matches.isEmpty())
+        matches << pattern;
+    return matches;
+}
+#endif
+
+/*!
+    Completes the .qch file of \a project and closes it.
+
+    The generated pages were added while they were written; the
+    remaining \a files of the project, such as images, style sheets,
+    and extra files, are read from the output directory. The table
+    of contents and the keywords collected by generateProject() are
+    added last.
+ */
+void HelpProjectWriter::generateQch(HelpProject &project, const QStringList &files)
+{
+#ifndef QDOC_NO_QCH
+    if (!openQch(project))
+        return;
+    QchWriter *qch = project.m_qchWriter;
+
+    // Images are copied in the background; they must be complete
+    // before they can be read.
+    FileCopier::instance().wait_for_pending_copies();
+
+    QHash<QString, QStringList> dirEntries;
+    for (const auto &pattern : files) {
+        if (pattern.isEmpty())
+            continue;
+        const QStringList matches = matchingFiles(m_outputDir, pattern, dirEntries);
+        for (const auto &fileName : matches) {
+            if (qch->hasFile(fileName))
+                continue;
+            QFile file(m_outputDir + u'/' + fileName);
+            if (!file.open(QFile::ReadOnly)) {
+                Config::instance().location().warning(
+                        u"Cannot add file '%1' to help file '%2': %3"_s.arg(
+                                fileName, project.m_qchFileName, file.errorString()));
+                continue;
+            }
+            const QByteArray data = file.readAll();
+            QString title;
+            if (fileName.endsWith(".html"_L1) || fileName.endsWith(".htm"_L1))
+                title = documentTitle(data);
+            if (title.isEmpty())
+                title = fileName.mid(fileName.lastIndexOf(u'/') + 1);
+            qch->addFile(fileName, title, data);
+        }
+    }
+
+    qch->addContents(project.m_contents);
+    for (const auto &keyword : std::as_const(project.m_keywords)) {
+        for (const auto &id : keyword.m_ids)
+            qch->addKeyword(keyword.m_name, id, keyword.m_ref);
+    }
+
+    if (!qch->close())
+        Config::instance().location().warning(u"Cannot write help file '%1': %2"_s.arg(
+                project.m_qchFileName, qch->errorString()));
+    delete qch;
+    project.m_qchWriter = nullptr;
+#else
+    Q_UNUSED(project);
+    Q_UNUSED(files);
+#endif
+}
+
+void HelpProjectWriter::clearQchWriters()
+{
+#ifndef QDOC_NO_QCH
+    for (HelpProject &project : m_projects) {
+        delete project.m_qchWriter;
+        project.m_qchWriter = nullptr;
+    }
+#endif
 }
 
 QT_END_NAMESPACE
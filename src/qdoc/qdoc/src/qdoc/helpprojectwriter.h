@@ -15,6 +15,7 @@ QT_BEGIN_NAMESPACE
 
 class QDocDatabase;
 class Generator;
+class QchWriter;
 
 using NodeTypeSet = QSet<unsigned char>;
 
@@ -74,6 +75,10 @@ struct HelpProject
     QList<SubProject> m_subprojects {};
     QHash<const Node *, NodeStatusSet> m_memberStatus {};
     bool m_includeIndexNodes {};
+    QString m_qchFileName {};
+    QchWriter *m_qchWriter {};
+    QByteArray m_contents {};
+    int m_sectionDepth {};
 };
 
 
@@ -81,10 +86,15 @@ class HelpProjectWriter
 {
 public:
     HelpProjectWriter(const QString &defaultFileName, Generator *g);
+    ~HelpProjectWriter();
     void reset(const QString &defaultFileName, Generator *g);
     void addExtraFile(const QString &file);
     void generate();
 
+    [[nodiscard]] bool writesQch() const;
+    void setPageTitle(const QString &fileName, const QString &title);
+    void addPage(const QString &fileName, const QByteArray &contents);
+
 private:
     void generateProject(HelpProject &project);
     void generateSections(HelpProject &project, QXmlStreamWriter &writer, const Node *node);
@@ -93,13 +103,21 @@ private:
     void writeNode(HelpProject &project, QXmlStreamWriter &writer, const Node *node);
     void readSelectors(SubProject &subproject, const QStringList &selectors);
     void addMembers(HelpProject &project, QXmlStreamWriter &writer, const Node *node);
-    void writeSection(QXmlStreamWriter &writer, const QString &path, const QString &value);
+    void writeSection(HelpProject &project, QXmlStreamWriter &writer, const QString &path,
+                      const QString &value);
+    void startSection(HelpProject &project, QXmlStreamWriter &writer, const QString &path,
+                      const QString &value);
+    void endSection(HelpProject &project, QXmlStreamWriter &writer);
+    bool openQch(HelpProject &project);
+    void generateQch(HelpProject &project, const QStringList &files);
+    void clearQchWriters();
 
     QDocDatabase *m_qdb {};
     Generator *m_gen {};
 
     QString m_outputDir {};
     QList<HelpProject> m_projects {};
+    QHash<QString, QString> m_pageTitles {};
 };
 
 QT_END_NAMESPACE
@@ -18,12 +18,14 @@
 #include "propertynode.h"
 #include "qdocdatabase.h"
 #include "qmlpropertynode.h"
+#include "searchindexwriter.h"
 #include "sharedcommentnode.h"
 #include "tagfilewriter.h"
 #include "tree.h"
 #include "quoter.h"
 #include "utilities.h"
 
+#include <QtCore/qdir.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qmap.h>
 #include <QtCore/quuid.h>
@@ -84,7 +86,8 @@ inline void HtmlGenerator::closeUnorderedList()
 
 /*!
   Destroys the HTML output generator. Deletes the singleton
-  instance of HelpProjectWriter and the ManifestWriter instance.
+  instance of HelpProjectWriter, the ManifestWriter instance and
+  the SearchIndexWriter instance, if any.
  */
 HtmlGenerator::~HtmlGenerator()
 {
@@ -97,6 +100,9 @@ HtmlGenerator::~HtmlGenerator()
         delete m_manifestWriter;
         m_manifestWriter = nullptr;
     }
+
+    delete m_searchIndexWriter;
+    m_searchIndexWriter = nullptr;
 }
 
 /*!
@@ -173,6 +179,17 @@ void HtmlGenerator::initializeGenerator()
     if (!m_manifestWriter)
         m_manifestWriter = new ManifestWriter();
 
+    // The search index is per format, so that WebXML output doesn't inherit it
+    if (config->get(format() + Config::dot + HTMLGENERATOR_SEARCHINDEX).asBool()) {
+        if (m_searchIndexWriter)
+            m_searchIndexWriter->clear();
+        else
+            m_searchIndexWriter = new SearchIndexWriter;
+    } else {
+        delete m_searchIndexWriter;
+        m_searchIndexWriter = nullptr;
+    }
+
     // Documentation template handling
     m_headerScripts = config->get(formatDot + CONFIG_HEADERSCRIPTS).asString();
     m_headerStyles = config->get(formatDot + CONFIG_HEADERSTYLES).asString();
@@ -220,6 +237,28 @@ void HtmlGenerator::terminateGenerator()
     Generator::terminateGenerator();
 }
 
+/*!
+  Returns \c true if the generated pages are needed in memory, for
+  precompression or for writing them directly to a .qch file.
+ */
+bool HtmlGenerator::keepsPageContents() const
+{
+    return Generator::keepsPageContents()
+            || (m_helpProjectWriter && m_helpProjectWriter->writesQch());
+}
+
+/*!
+  Passes the completed page at \a filePath, with the given
+  \a contents, to the help project writer in addition to the
+  default handling.
+ */
+void HtmlGenerator::pageCompleted(const QString &filePath, const QByteArray &contents)
+{
+    Generator::pageCompleted(filePath, contents);
+    if (m_helpProjectWriter && m_helpProjectWriter->writesQch())
+        m_helpProjectWriter->addPage(QDir(outputDir()).relativeFilePath(filePath), contents);
+}
+
 QString HtmlGenerator::format()
 {
     return "HTML";
@@ -231,7 +270,8 @@ QString HtmlGenerator::format()
 
   If qdoc is in the \c {-generate} phase, traverse the primary
   tree to generate all the HTML documentation for the current
-  module. Then generate the help file and the tag file.
+  module. Then generate the help file, the search index and the
+  tag file.
  */
 void HtmlGenerator::generateDocs()
 {
@@ -251,6 +291,12 @@ void HtmlGenerator::generateDocs()
     if (!config->preparing()) {
         m_helpProjectWriter->generate();
         m_manifestWriter->generateManifestFiles();
+        if (m_searchIndexWriter) {
+            QString errorString;
+            if (!m_searchIndexWriter->generate(outputDir(), &errorString))
+                Location().warning(errorString);
+            m_searchIndexWriter->clear();
+        }
         /*
           Generate the XML tag file, if it was requested.
         */
@@ -1078,10 +1124,10 @@ void HtmlGenerator::generateCppReferencePage(Aggregate *aggregate, CodeMarker *m
     QString rawTitle;
     QString fullTitle;
     NamespaceNode *ns = nullptr;
-    SectionVector *summarySections = nullptr;
-    SectionVector *detailsSections = nullptr;
+    const SectionVector *summarySections = nullptr;
+    const SectionVector *detailsSections = nullptr;
 
-    Sections sections(aggregate);
+    const Sections &sections = Sections::forAggregate(aggregate);
     QString word = aggregate->typeWord(true);
     auto templateDecl = aggregate->templateDecl();
     if (aggregate->isNamespace()) {
@@ -1149,7 +1195,7 @@ void HtmlGenerator::generateCppReferencePage(Aggregate *aggregate, CodeMarker *m
     if (parentIsClass)
         generateSince(aggregate, marker);
 
-    QString membersLink = generateAllMembersFile(Sections::allMembersSection(), marker);
+    QString membersLink = generateAllMembersFile(sections.allMembersSection(), marker);
     if (!membersLink.isEmpty()) {
         openUnorderedList();
         out() << "<li><a href=\"" << membersLink << "\">"
@@ -1299,10 +1345,10 @@ void HtmlGenerator::generateProxyPage(Aggregate *aggregate, CodeMarker *marker)
     QString rawTitle;
     QString fullTitle;
     Text subtitleText;
-    SectionVector *summarySections = nullptr;
-    SectionVector *detailsSections = nullptr;
+    const SectionVector *summarySections = nullptr;
+    const SectionVector *detailsSections = nullptr;
 
-    Sections sections(aggregate);
+    const Sections &sections = Sections::forAggregate(aggregate);
     rawTitle = aggregate->plainName();
     fullTitle = aggregate->plainFullName();
     title = rawTitle + " Proxy Page";
@@ -1394,7 +1440,7 @@ void HtmlGenerator::generateQmlTypePage(QmlTypeNode *qcn, CodeMarker *marker)
 
 
     generateHeader(htmlTitle, qcn, marker);
-    Sections sections(qcn);
+    const Sections &sections = Sections::forAggregate(qcn);
     generateTableOfContents(qcn, marker, &sections.stdQmlTypeSummarySections());
     marker = CodeMarker::markerForLanguage(QLatin1String("QML"));
     generateTitle(htmlTitle, Text() << qcn->subtitle(), subTitleSize, qcn, marker);
@@ -1748,6 +1794,9 @@ void HtmlGenerator::generateNavigationBar(const QString &title, const Node *node
 
 void HtmlGenerator::generateHeader(const QString &title, const Node *node, CodeMarker *marker)
 {
+    if (m_searchIndexWriter && node && outFileName() == fileName(node))
+        addToSearchIndex(title, node);
+
     out() << "<!DOCTYPE html>\n";
     out() << QString("<html lang=\"%1\">\n").arg(naturalLanguage);
     out() << "<head>\n";
@@ -1778,12 +1827,12 @@ void HtmlGenerator::generateHeader(const QString &title, const Node *node, CodeM
     if (title == titleSuffix)
         titleSuffix.clear();
 
-    out() << "  <title>";
-    if (!titleSuffix.isEmpty() && !title.isEmpty()) {
-        out() << "%1 | %2"_L1.arg(protectEnc(title), titleSuffix);
-    } else {
-        out() << protectEnc(title);
-    }
+    // The contents of the <title> element, also stored for the page in a .qch file
+    QString documentTitle;
+    if (!titleSuffix.isEmpty() && !title.isEmpty())
+        documentTitle = "%1 | %2"_L1.arg(protectEnc(title), titleSuffix);
+    else
+        documentTitle = protectEnc(title);
 
     // append a full version to the suffix if neither suffix nor title
     // include (a prefix of) version information
@@ -1798,11 +1847,13 @@ void HtmlGenerator::generateHeader(const QString &title, const Node *node, CodeM
         if (titleVersion.isNull() || !titleVersion.isPrefixOf(projectVersion)) {
             // Prefix with product name if one exists
             if (!m_productName.isEmpty() && titleSuffix != m_productName)
-                out() << " | %1"_L1.arg(m_productName);
-            out() << " %1"_L1.arg(projectVersion.toString());
+                documentTitle += " | %1"_L1.arg(m_productName);
+            documentTitle += " %1"_L1.arg(projectVersion.toString());
         }
     }
-    out() << "</title>\n";
+    out() << "  <title>" << documentTitle << "</title>\n";
+    m_helpProjectWriter->setPageTitle(QDir(outputDir()).relativeFilePath(outFilePath()),
+                                      documentTitle);
 
     // Include style sheet and script links.
     out() << m_headerStyles;
@@ -2296,7 +2347,7 @@ void HtmlGenerator::generateBrief(const Node *node, CodeMarker *marker, const No
   Generates a table of contents beginning at \a node.
  */
 void HtmlGenerator::generateTableOfContents(const Node *node, CodeMarker *marker,
-                                            QList<Section> *sections)
+                                            const QList<Section> *sections)
 {
     QList<Atom *> toc;
     if (node->doc().hasTableOfContents())
@@ -2442,7 +2493,7 @@ QString HtmlGenerator::generateAllQmlMembersFile(const Sections &sections, CodeM
     generateFullName(aggregate, nullptr);
     out() << ", including inherited members.</p>\n";
 
-    ClassNodesList &cknl = sections.allMembersSection().classNodesList();
+    const ClassNodesList &cknl = sections.allMembersSection().classNodesList();
     for (int i = 0; i < cknl.size(); i++) {
         ClassNodes ckn = cknl[i];
         const QmlTypeNode *qcn = ckn.first;
@@ -3399,6 +3450,28 @@ QString HtmlGenerator::protect(const QString &string)
 #undef APPEND
 }
 
+/*!
+  Adds the page for \a node, with the given \a title, to the search
+  index. Besides the title, the page's \\keyword entries, the plain
+  text of its documentation and the names of its members are indexed.
+ */
+void HtmlGenerator::addToSearchIndex(const QString &title, const Node *node)
+{
+    QStringList keywords;
+    for (const Atom *keyword : node->doc().keywords())
+        keywords << keyword->string();
+
+    QString text = node->doc().body().toString();
+    if (node->isAggregate()) {
+        for (const auto *child : static_cast<const Aggregate *>(node)->childNodes()) {
+            if (child->isInAPI())
+                text += QLatin1Char(' ') + child->name();
+        }
+    }
+
+    m_searchIndexWriter->addPage(outFileName(), title, keywords, text);
+}
+
 QString HtmlGenerator::fileBase(const Node *node) const
 {
     QString result = Generator::fileBase(node);
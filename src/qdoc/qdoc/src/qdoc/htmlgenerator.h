@@ -18,6 +18,7 @@ class Config;
 class ExampleNode;
 class HelpProjectWriter;
 class ManifestWriter;
+class SearchIndexWriter;
 
 class HtmlGenerator : public XmlGenerator
 {
@@ -43,6 +44,8 @@ protected:
     void generateCollectionNode(CollectionNode *cn, CodeMarker *marker) override;
     void generateGenericCollectionPage(CollectionNode *cn, CodeMarker *marker) override;
     [[nodiscard]] QString fileExtension() const override;
+    [[nodiscard]] bool keepsPageContents() const override;
+    void pageCompleted(const QString &filePath, const QByteArray &contents) override;
 
 private:
     enum SubTitleSize { SmallSubTitle, LargeSubTitle };
@@ -55,12 +58,13 @@ private:
     void generateTitle(const QString &title, const Text &subTitle, SubTitleSize subTitleSize,
                        const Node *relative, CodeMarker *marker);
     void generateFooter(const Node *node = nullptr);
+    void addToSearchIndex(const QString &title, const Node *node);
     void generateRequisites(Aggregate *inner, CodeMarker *marker);
     void generateQmlRequisites(QmlTypeNode *qcn, CodeMarker *marker);
     void generateBrief(const Node *node, CodeMarker *marker, const Node *relative = nullptr,
                        bool addLink = true);
     void generateTableOfContents(const Node *node, CodeMarker *marker,
-                                 QList<Section> *sections = nullptr);
+                                 const QList<Section> *sections = nullptr);
     void generateSidebar();
     QString generateAllMembersFile(const Section &section, CodeMarker *marker);
     QString generateAllQmlMembersFile(const Sections &sections, CodeMarker *marker);
@@ -135,6 +139,7 @@ private:
     QString m_codeSuffix {};
     HelpProjectWriter *m_helpProjectWriter { nullptr };
     ManifestWriter *m_manifestWriter { nullptr };
+    SearchIndexWriter *m_searchIndexWriter { nullptr };
     QString m_headerScripts {};
     QString m_headerStyles {};
     QString m_endHeader {};
@@ -172,6 +177,7 @@ private:
 #define HTMLGENERATOR_POSTHEADER "postheader"
 #define HTMLGENERATOR_POSTPOSTHEADER "postpostheader"
 #define HTMLGENERATOR_PROLOGUE "prologue"
+#define HTMLGENERATOR_SEARCHINDEX "searchindex"
 #define HTMLGENERATOR_NONAVIGATIONBAR "nonavigationbar"
 #define HTMLGENERATOR_NAVIGATIONSEPARATOR "navigationseparator"
 #define HTMLGENERATOR_TOCDEPTH "tocdepth"
@@ -0,0 +1,161 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "outputcompressor.h"
+
+#include <QtCore/qfile.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qtendian.h>
+
+#include <array>
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+
+using namespace Qt::StringLiterals;
+
+/*!
+  \class OutputCompressor
+  \internal
+  \brief Writes precompressed siblings of generated output files.
+
+  Static file servers can serve \c {page.html.gz} in place of
+  \c {page.html} to clients that accept gzip encoding. When the
+  \c {<FORMAT>.precompress} configuration variable is set, the
+  generator hands the bytes of each page to an OutputCompressor as
+  the page is finalized, and the compressed sibling is written on a
+  background thread pool. The page is never read back from disk.
+
+  The gzip trailer stores the CRC-32 and the size of the uncompressed
+  data. Before compressing, the trailer of an existing sibling is
+  compared against the new contents; if both match, the page did not
+  change since the previous run and no work is done.
+
+  Errors cannot be reported from the worker threads, so they are
+  collected and returned by waitForDone().
+ */
+
+/*!
+  Constructs an idle compressor.
+ */
+OutputCompressor::OutputCompressor() = default;
+
+/*!
+  Waits for all pending compression jobs before destroying the
+  compressor. Errors that have not been collected with waitForDone()
+  are dropped.
+ */
+OutputCompressor::~OutputCompressor()
+{
+    m_pool.waitForDone();
+}
+
+/*!
+  Schedules writing \a{filePath}.gz, containing \a contents in gzip
+  format. Returns immediately.
+ */
+void OutputCompressor::compress(const QString &filePath, const QByteArray &contents)
+{
+    m_pool.start([this, filePath, contents]() { writeCompressed(filePath, contents); });
+}
+
+/*!
+  Blocks until all scheduled files are written. Returns the
+  messages of the errors that occurred since the last call.
+ */
+QStringList OutputCompressor::waitForDone()
+{
+    m_pool.waitForDone();
+    QMutexLocker locker(&m_mutex);
+    return std::exchange(m_errors, {});
+}
+
+void OutputCompressor::writeCompressed(const QString &filePath, const QByteArray &contents)
+{
+    const QString gzPath = filePath + ".gz"_L1;
+    if (isUpToDate(gzPath, crc32(contents), contents.size()))
+        return;
+
+    QSaveFile file(gzPath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(gzip(contents)) < 0 || !file.commit()) {
+        QMutexLocker locker(&m_mutex);
+        m_errors << u"Cannot write compressed output file '%1': %2"_s.arg(gzPath,
+                                                                          file.errorString());
+    }
+}
+
+/*!
+  Returns \c true if \a compressedFilePath is a gzip file whose
+  trailer records an uncompressed payload with the checksum \a crc
+  and \a size bytes.
+ */
+bool OutputCompressor::isUpToDate(const QString &compressedFilePath, quint32 crc, qint64 size)
+{
+    QFile file(compressedFilePath);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < 18)
+        return false;
+
+    char trailer[8];
+    if (!file.seek(file.size() - 8) || file.read(trailer, 8) != 8)
+        return false;
+
+    return qFromLittleEndian<quint32>(trailer) == crc
+            && qFromLittleEndian<quint32>(trailer + 4) == quint32(size);
+}
+
+/*!
+  Returns the CRC-32 (ISO 3309) checksum of \a contents, as used in
+  the gzip trailer.
+ */
+quint32 OutputCompressor::crc32(const QByteArray &contents)
+{
+    static const auto table = [] {
+        std::array<quint32, 256> t {};
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xedb88320U ^ (c >> 1) : (c >> 1);
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    quint32 crc = 0xffffffffU;
+    for (const char ch : contents)
+        crc = table[(crc ^ quint8(ch)) & 0xff] ^ (crc >> 8);
+    return crc ^ 0xffffffffU;
+}
+
+/*!
+  Returns \a contents compressed in gzip (RFC 1952) format.
+
+  qCompress() produces a zlib stream, prefixed with the uncompressed
+  size. The raw deflate data in its middle is reused as is, and only
+  the zlib header and Adler-32 trailer are replaced by their gzip
+  counterparts.
+ */
+QByteArray OutputCompressor::gzip(const QByteArray &contents)
+{
+    // size prefix (4), zlib header (2), adler-32 trailer (4)
+    constexpr qsizetype zlibOverhead = 4 + 2 + 4;
+    static const char header[] = { '\x1f', '\x8b', '\x08', '\x00', '\x00', '\x00',
+                                   '\x00', '\x00', '\x00', '\xff' };
+
+    const QByteArray zlib = qCompress(contents, 9);
+
+    QByteArray result;
+    result.reserve(sizeof(header) + zlib.size() + 8);
+    result.append(header, sizeof(header));
+    if (zlib.size() > zlibOverhead)
+        result.append(zlib.constData() + 6, zlib.size() - zlibOverhead);
+    else
+        result.append("\x03\x00", 2); // empty final deflate block
+
+    char trailer[8];
+    qToLittleEndian<quint32>(crc32(contents), trailer);
+    qToLittleEndian<quint32>(quint32(contents.size()), trailer + 4);
+    result.append(trailer, sizeof(trailer));
+    return result;
+}
+
+QT_END_NAMESPACE
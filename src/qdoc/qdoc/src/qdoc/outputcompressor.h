@@ -0,0 +1,38 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef OUTPUTCOMPRESSOR_H
+#define OUTPUTCOMPRESSOR_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qthreadpool.h>
+
+QT_BEGIN_NAMESPACE
+
+class OutputCompressor
+{
+public:
+    OutputCompressor();
+    ~OutputCompressor();
+
+    void compress(const QString &filePath, const QByteArray &contents);
+    QStringList waitForDone();
+
+    static QByteArray gzip(const QByteArray &contents);
+    static quint32 crc32(const QByteArray &contents);
+    static bool isUpToDate(const QString &compressedFilePath, quint32 crc, qint64 size);
+
+private:
+    void writeCompressed(const QString &filePath, const QByteArray &contents);
+
+    QThreadPool m_pool {};
+    QMutex m_mutex {};
+    QStringList m_errors {};
+};
+
+QT_END_NAMESPACE
+
+#endif
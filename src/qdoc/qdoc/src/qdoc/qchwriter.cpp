@@ -0,0 +1,318 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "qchwriter.h"
+
+#include <QtCore/qdir.h>
+#include <QtCore/qfileinfo.h>
+#include <QtSql/qsqldatabase.h>
+#include <QtSql/qsqlerror.h>
+#include <QtSql/qsqlquery.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+using namespace Qt::StringLiterals;
+
+/*!
+  \class QchWriter
+  \internal
+  \brief Writes a Qt compressed help (.qch) file while the
+  documentation is generated.
+
+  The usual way to obtain a .qch file is to let qhelpgenerator read
+  the .qhp project written by HelpProjectWriter, after which it reads
+  every listed file back from disk, compresses it, and inserts it
+  into an SQLite database. QDoc already holds the contents and the
+  title of each page when it finishes writing it, so a QchWriter
+  takes the pages as they are generated instead, and produces the
+  same database schema as qhelpgenerator.
+
+  The writer is opened with the namespace, virtual folder, and filter
+  attributes of a help project. Files, keywords, and the serialized
+  table of contents are then added in any order, except that the
+  files a keyword refers to must be added before the keyword. All
+  inserts happen in a single transaction, committed by close().
+
+  Only a single filter section is supported, which is all that
+  HelpProjectWriter generates.
+ */
+
+/*!
+  Constructs a writer that is not open.
+ */
+QchWriter::QchWriter() = default;
+
+/*!
+  Destroys the writer, committing what was written if it is
+  still open.
+ */
+QchWriter::~QchWriter()
+{
+    close();
+}
+
+/*!
+  Creates the help file \a filePath, replacing any existing file, for
+  the help namespace \a helpNamespace and the virtual folder
+  \a virtualFolder. All files, keywords, and contents that are added
+  later are associated with \a filterAttributes.
+
+  Returns \c false and sets the error string if the file cannot be
+  created.
+ */
+bool QchWriter::open(const QString &filePath, const QString &helpNamespace,
+                     const QString &virtualFolder, const QStringList &filterAttributes)
+{
+    close();
+    m_error.clear();
+
+    if (helpNamespace.isEmpty() || virtualFolder.isEmpty()) {
+        m_error = u"Cannot write help file '%1': missing namespace or virtual folder"_s.arg(
+                filePath);
+        return false;
+    }
+
+    QFileInfo fileInfo(filePath);
+    if (fileInfo.exists() && !fileInfo.dir().remove(fileInfo.fileName())) {
+        m_error = u"The file '%1' cannot be overwritten"_s.arg(filePath);
+        return false;
+    }
+
+    m_connectionName = u"qdoc-qch-%1"_s.arg(quintptr(this), 0, 16);
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE"_L1, m_connectionName);
+        db.setDatabaseName(filePath);
+        if (db.open())
+            m_query = new QSqlQuery(db);
+    }
+    if (!m_query) {
+        m_error = u"Cannot open database file '%1'"_s.arg(filePath);
+        QSqlDatabase::removeDatabase(m_connectionName);
+        return false;
+    }
+
+    m_query->exec("PRAGMA synchronous=OFF"_L1);
+    m_query->exec("PRAGMA cache_size=3000"_L1);
+    m_query->exec("BEGIN"_L1);
+
+    if (!createTables()
+        || !exec("INSERT INTO NamespaceTable VALUES(NULL, ?)"_L1, { helpNamespace })) {
+        close();
+        return false;
+    }
+    m_namespaceId = m_query->lastInsertId().toInt();
+
+    if (!exec("INSERT INTO FolderTable (NamespaceId, Name) VALUES (?, ?)"_L1,
+              { m_namespaceId, virtualFolder })) {
+        close();
+        return false;
+    }
+    m_virtualFolderId = m_query->lastInsertId().toInt();
+
+    // The entry returned for files that are missing from the database.
+    exec("INSERT INTO FileDataTable VALUES (NULL, ?)"_L1, { QByteArray() });
+    exec("INSERT INTO FileNameTable (FolderId, Name, FileId, Title) VALUES (0, '', ?, '')"_L1,
+         { m_query->lastInsertId() });
+
+    for (const auto &attribute : filterAttributes)
+        m_filterAttributeIds.append(attributeId(attribute));
+    std::sort(m_filterAttributeIds.begin(), m_filterAttributeIds.end());
+    m_filterAttributeIds.erase(std::unique(m_filterAttributeIds.begin(), m_filterAttributeIds.end()),
+                               m_filterAttributeIds.end());
+    for (const int id : std::as_const(m_filterAttributeIds))
+        exec("INSERT INTO FileAttributeSetTable VALUES(1, ?)"_L1, { id });
+
+    return m_error.isEmpty();
+}
+
+/*!
+  Commits everything that was added and closes the file. Returns
+  \c false if an error occurred since the writer was opened; the
+  first such error is available from errorString().
+ */
+bool QchWriter::close()
+{
+    if (!m_query)
+        return m_error.isEmpty();
+
+    if (!m_query->exec("COMMIT"_L1) && m_error.isEmpty())
+        m_error = m_query->lastError().text();
+    m_query->clear();
+    delete m_query;
+    m_query = nullptr;
+    QSqlDatabase::removeDatabase(m_connectionName);
+
+    m_namespaceId = -1;
+    m_virtualFolderId = -1;
+    m_filterAttributeIds.clear();
+    m_attributeIds.clear();
+    m_fileIds.clear();
+    m_keywordIds.clear();
+    return m_error.isEmpty();
+}
+
+bool QchWriter::createTables()
+{
+    static const char *const tables[] = {
+        "CREATE TABLE NamespaceTable (Id INTEGER PRIMARY KEY, Name TEXT )",
+        "CREATE TABLE FilterAttributeTable (Id INTEGER PRIMARY KEY, Name TEXT )",
+        "CREATE TABLE FilterNameTable (Id INTEGER PRIMARY KEY, Name TEXT )",
+        "CREATE TABLE FilterTable (NameId INTEGER, FilterAttributeId INTEGER )",
+        "CREATE TABLE IndexTable (Id INTEGER PRIMARY KEY, Name TEXT, Identifier TEXT, "
+        "NamespaceId INTEGER, FileId INTEGER, Anchor TEXT )",
+        "CREATE TABLE IndexFilterTable (FilterAttributeId INTEGER, IndexId INTEGER )",
+        "CREATE TABLE ContentsTable (Id INTEGER PRIMARY KEY, NamespaceId INTEGER, Data BLOB )",
+        "CREATE TABLE ContentsFilterTable (FilterAttributeId INTEGER, ContentsId INTEGER )",
+        "CREATE TABLE FileAttributeSetTable (Id INTEGER, FilterAttributeId INTEGER )",
+        "CREATE TABLE FileDataTable (Id INTEGER PRIMARY KEY, Data BLOB )",
+        "CREATE TABLE FileFilterTable (FilterAttributeId INTEGER, FileId INTEGER )",
+        "CREATE TABLE FileNameTable (FolderId INTEGER, Name TEXT, FileId INTEGER, Title TEXT )",
+        "CREATE TABLE FolderTable(Id INTEGER PRIMARY KEY, Name Text, NamespaceID INTEGER )",
+        "CREATE TABLE MetaDataTable(Name Text, Value BLOB )",
+    };
+
+    for (const char *table : tables) {
+        if (!exec(QLatin1StringView(table)))
+            return false;
+    }
+    return exec("INSERT INTO MetaDataTable VALUES('qchVersion', '1.0')"_L1);
+}
+
+/*!
+  Prepares \a statement, binds \a values to its placeholders in
+  order, and executes it. Records the first error that occurs.
+ */
+bool QchWriter::exec(const QString &statement, const QVariantList &values)
+{
+    if (!m_query)
+        return false;
+
+    m_query->prepare(statement);
+    for (qsizetype i = 0; i < values.size(); ++i)
+        m_query->bindValue(int(i), values.at(i));
+    if (m_query->exec())
+        return true;
+
+    if (m_error.isEmpty())
+        m_error = m_query->lastError().text();
+    return false;
+}
+
+/*!
+  Returns the id of the filter attribute \a attribute, registering
+  it if needed.
+ */
+int QchWriter::attributeId(const QString &attribute)
+{
+    auto it = m_attributeIds.constFind(attribute);
+    if (it != m_attributeIds.cend())
+        return *it;
+
+    if (!exec("INSERT INTO FilterAttributeTable VALUES(NULL, ?)"_L1, { attribute }))
+        return -1;
+    const int id = m_query->lastInsertId().toInt();
+    m_attributeIds.insert(attribute, id);
+    return id;
+}
+
+/*!
+  Adds the meta data \a name with the given \a value.
+ */
+void QchWriter::addMetaData(const QString &name, const QVariant &value)
+{
+    exec("INSERT INTO MetaDataTable VALUES(?, ?)"_L1, { name, value });
+}
+
+/*!
+  Registers the custom filter \a name, which selects
+  \a filterAttributes.
+ */
+void QchWriter::addCustomFilter(const QString &name, const QStringList &filterAttributes)
+{
+    if (!exec("INSERT INTO FilterNameTable VALUES(NULL, ?)"_L1, { name }))
+        return;
+    const int nameId = m_query->lastInsertId().toInt();
+    for (const auto &attribute : filterAttributes)
+        exec("INSERT INTO FilterTable VALUES(?, ?)"_L1, { nameId, attributeId(attribute) });
+}
+
+/*!
+  Adds the file \a fileName, relative to the root of the project,
+  with the given \a title and contents \a data. A file that was
+  already added is ignored.
+ */
+bool QchWriter::addFile(const QString &fileName, const QString &title, const QByteArray &data)
+{
+    const QString name = QDir::cleanPath(fileName);
+    if (!m_query || m_fileIds.contains(name))
+        return m_query != nullptr;
+
+    if (!exec("INSERT INTO FileDataTable VALUES (NULL, ?)"_L1, { qCompress(data) }))
+        return false;
+    const int fileId = m_query->lastInsertId().toInt();
+    m_fileIds.insert(name, fileId);
+
+    for (const int id : std::as_const(m_filterAttributeIds))
+        exec("INSERT INTO FileFilterTable VALUES(?, ?)"_L1, { id, fileId });
+    return exec("INSERT INTO FileNameTable (FolderId, Name, FileId, Title) VALUES (?, ?, ?, ?)"_L1,
+                { m_virtualFolderId, name, fileId, title });
+}
+
+/*!
+  Returns \c true if \a fileName was added with addFile().
+ */
+bool QchWriter::hasFile(const QString &fileName) const
+{
+    return m_fileIds.contains(QDir::cleanPath(fileName));
+}
+
+/*!
+  Adds a keyword with the given \a name and \a id, referring to
+  \a ref, a file name optionally followed by an anchor.
+
+  As in qhelpgenerator, keywords that repeat a non-empty id are
+  ignored.
+ */
+void QchWriter::addKeyword(const QString &name, const QString &id, const QString &ref)
+{
+    if (!m_query || m_keywordIds.contains(id))
+        return;
+    if (!id.isEmpty())
+        m_keywordIds.insert(id);
+
+    const qsizetype hash = ref.indexOf(u'#');
+    const QString anchor = hash < 0 ? QString() : ref.mid(hash + 1);
+    const int fileId = m_fileIds.value(QDir::cleanPath(ref.left(hash)), 1);
+
+    if (!exec("INSERT INTO IndexTable (Name, Identifier, NamespaceId, FileId, Anchor) "
+              "VALUES(?, ?, ?, ?, ?)"_L1,
+              { name, id, m_namespaceId, fileId, anchor })) {
+        return;
+    }
+    const int indexId = m_query->lastInsertId().toInt();
+    for (const int filterId : std::as_const(m_filterAttributeIds))
+        exec("INSERT INTO IndexFilterTable (FilterAttributeId, IndexId) VALUES(?, ?)"_L1,
+             { filterId, indexId });
+}
+
+/*!
+  Adds the table of contents \a contents, serialized as qhelpgenerator
+  does: a sequence of depth, reference, and title for each section, in
+  document order.
+ */
+bool QchWriter::addContents(const QByteArray &contents)
+{
+    if (!exec("INSERT INTO ContentsTable (NamespaceId, Data) VALUES(?, ?)"_L1,
+              { m_namespaceId, contents })) {
+        return false;
+    }
+    const int contentsId = m_query->lastInsertId().toInt();
+    for (const int filterId : std::as_const(m_filterAttributeIds))
+        exec("INSERT INTO ContentsFilterTable (FilterAttributeId, ContentsId) VALUES(?, ?)"_L1,
+             { filterId, contentsId });
+    return m_error.isEmpty();
+}
+
+QT_END_NAMESPACE
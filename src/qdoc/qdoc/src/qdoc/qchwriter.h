@@ -0,0 +1,58 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef QCHWRITER_H
+#define QCHWRITER_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qset.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qvariant.h>
+
+QT_BEGIN_NAMESPACE
+
+class QSqlQuery;
+
+class QchWriter
+{
+public:
+    QchWriter();
+    ~QchWriter();
+
+    bool open(const QString &filePath, const QString &helpNamespace, const QString &virtualFolder,
+              const QStringList &filterAttributes);
+    bool close();
+
+    [[nodiscard]] bool isOpen() const { return m_query != nullptr; }
+    [[nodiscard]] QString errorString() const { return m_error; }
+
+    void addMetaData(const QString &name, const QVariant &value);
+    void addCustomFilter(const QString &name, const QStringList &filterAttributes);
+    bool addFile(const QString &fileName, const QString &title, const QByteArray &data);
+    [[nodiscard]] bool hasFile(const QString &fileName) const;
+    void addKeyword(const QString &name, const QString &id, const QString &ref);
+    bool addContents(const QByteArray &contents);
+
+private:
+    bool exec(const QString &statement, const QVariantList &values = {});
+    int attributeId(const QString &attribute);
+    bool createTables();
+
+    QSqlQuery *m_query { nullptr };
+    QString m_connectionName {};
+    QString m_error {};
+
+    int m_namespaceId { -1 };
+    int m_virtualFolderId { -1 };
+    QList<int> m_filterAttributeIds {};
+    QHash<QString, int> m_attributeIds {};
+    QHash<QString, int> m_fileIds {};
+    QSet<QString> m_keywordIds {};
+};
+
+QT_END_NAMESPACE
+
+#endif // QCHWRITER_H
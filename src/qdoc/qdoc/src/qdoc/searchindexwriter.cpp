@@ -0,0 +1,232 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "searchindexwriter.h"
+
+#include <QtCore/qdir.h>
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qjsonobject.h>
+#include <QtCore/qmap.h>
+#include <QtCore/qsavefile.h>
+
+QT_BEGIN_NAMESPACE
+
+using namespace Qt::StringLiterals;
+
+/*!
+  \class SearchIndexWriter
+  \internal
+  \brief Builds a static, client-side search index for the HTML output.
+
+  The HTML generator calls addPage() once for every page it writes,
+  passing the page's title, its \\keyword entries and its plain text.
+  The page is tokenized right away and its postings are appended to
+  an inverted index, that maps each term to the pages it occurs in
+  and the word positions inside each page. Words from the title and
+  the keywords come first, so that the loader can rank such matches
+  higher.
+
+  generate() writes the index to a \c search subdirectory of the
+  output directory:
+
+  \list
+    \li \c pages.json, an array of \c {[fileName, title, headerLength]}
+        entries, indexed by page id.
+    \li \c {index-<c>.json}, one shard for each first character of a
+        term, mapping the term to an array of postings. Each posting
+        is an array of the page id followed by the term's positions,
+        delta-encoded.
+    \li \c search.js, a small loader that fetches only the shards
+        needed for a query.
+  \endlist
+ */
+
+static const char searchLoader[] = R"JS(// Generated by QDoc.
+var QDocSearch = (function () {
+    'use strict';
+    var script = document.currentScript;
+    var base = script ? script.src.replace(/[^\/]*$/, '') : 'search/';
+    var cache = {};
+    function load(name) {
+        if (!cache[name]) {
+            cache[name] = fetch(base + name + '.json').then(function (r) {
+                return r.ok ? r.json() : {};
+            }, function () { return {}; });
+        }
+        return cache[name];
+    }
+    function tokenize(text) {
+        return (text.toLowerCase().match(/[\p{L}\p{N}_]+/gu) || []).filter(function (t) {
+            return t.length > 1;
+        });
+    }
+    function shard(term) {
+        var c = term.charAt(0);
+        return 'index-' + (/[a-z0-9]/.test(c) ? c : '_');
+    }
+    function search(query) {
+        var terms = tokenize(query);
+        if (!terms.length)
+            return Promise.resolve([]);
+        return Promise.all([load('pages')].concat(terms.map(function (t) {
+            return load(shard(t));
+        }))).then(function (data) {
+            var pages = data[0], scores = null;
+            terms.forEach(function (term, i) {
+                var index = data[i + 1], hits = {};
+                var keys = (i === terms.length - 1)
+                    ? Object.keys(index).filter(function (k) { return k.indexOf(term) === 0; })
+                    : (index[term] ? [term] : []);
+                keys.forEach(function (key) {
+                    index[key].forEach(function (posting) {
+                        var id = posting[0], pos = 0, score = 0;
+                        for (var j = 1; j < posting.length; ++j) {
+                            pos += posting[j];
+                            score += pos < pages[id][2] ? 10 : 1;
+                        }
+                        hits[id] = (hits[id] || 0) + (key === term ? score : score / 2);
+                    });
+                });
+                if (scores === null) {
+                    scores = hits;
+                } else {
+                    Object.keys(scores).forEach(function (id) {
+                        if (hits[id] === undefined)
+                            delete scores[id];
+                        else
+                            scores[id] += hits[id];
+                    });
+                }
+            });
+            return Object.keys(scores).map(function (id) {
+                return { file: pages[id][0], title: pages[id][1], score: scores[id] };
+            }).sort(function (a, b) { return b.score - a.score; });
+        });
+    }
+    return { search: search, tokenize: tokenize };
+})();
+)JS";
+
+/*!
+  Returns the search terms in \a text: lowercase runs of letters,
+  digits and underscores that are at least two characters long.
+ */
+QStringList SearchIndexWriter::tokenize(const QString &text)
+{
+    QStringList terms;
+    qsizetype start = -1;
+    for (qsizetype i = 0; i <= text.size(); ++i) {
+        const bool inWord = i < text.size()
+                && (text.at(i).isLetterOrNumber() || text.at(i) == u'_');
+        if (inWord && start < 0) {
+            start = i;
+        } else if (!inWord && start >= 0) {
+            if (i - start > 1)
+                terms << text.sliced(start, i - start).toLower();
+            start = -1;
+        }
+    }
+    return terms;
+}
+
+/*!
+  Returns the name of the index shard that holds \a term.
+ */
+QString SearchIndexWriter::shardName(const QString &term)
+{
+    const char16_t c = term.isEmpty() ? u'_' : term.front().unicode();
+    if ((c >= u'a' && c <= u'z') || (c >= u'0' && c <= u'9'))
+        return u"index-"_s + QChar(c);
+    return u"index-_"_s;
+}
+
+/*!
+  Adds the page \a fileName with the given \a title, \a keywords and
+  plain \a text to the index.
+ */
+void SearchIndexWriter::addPage(const QString &fileName, const QString &title,
+                                const QStringList &keywords, const QString &text)
+{
+    QStringList terms = tokenize(title);
+    for (const auto &keyword : keywords)
+        terms << tokenize(keyword);
+    const qsizetype headerLength = terms.size();
+    terms << tokenize(text);
+
+    const qsizetype page = m_pages.size();
+    m_pages.append({ fileName, title, headerLength });
+
+    QHash<QString, QList<qsizetype>> positions;
+    for (qsizetype i = 0; i < terms.size(); ++i)
+        positions[terms.at(i)].append(i);
+    for (auto it = positions.begin(); it != positions.end(); ++it)
+        m_postings[it.key()].append({ page, std::move(it.value()) });
+}
+
+/*!
+  Discards all pages added so far.
+ */
+void SearchIndexWriter::clear()
+{
+    m_pages.clear();
+    m_postings.clear();
+}
+
+static bool writeFile(const QString &path, const QByteArray &data, QString *errorString)
+{
+    QSaveFile file(path);
+    if (file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit())
+        return true;
+    if (errorString)
+        *errorString = u"Cannot write search index file '%1': %2"_s.arg(path, file.errorString());
+    return false;
+}
+
+/*!
+  Writes the index into the \c search subdirectory of \a outputDir.
+  Returns \c false and sets \a errorString if a file could not be
+  written.
+ */
+bool SearchIndexWriter::generate(const QString &outputDir, QString *errorString) const
+{
+    QDir dir(outputDir);
+    if (!dir.mkpath("search"_L1) || !dir.cd("search"_L1)) {
+        if (errorString)
+            *errorString = u"Cannot create search index directory in '%1'"_s.arg(outputDir);
+        return false;
+    }
+
+    QJsonArray pages;
+    for (const auto &page : m_pages)
+        pages.append(QJsonArray{ page.m_fileName, page.m_title, page.m_headerLength });
+    if (!writeFile(dir.filePath("pages.json"_L1),
+                   QJsonDocument(pages).toJson(QJsonDocument::Compact), errorString)) {
+        return false;
+    }
+
+    QMap<QString, QJsonObject> shards;
+    for (auto it = m_postings.cbegin(); it != m_postings.cend(); ++it) {
+        QJsonArray postings;
+        for (const auto &posting : it.value()) {
+            QJsonArray entry{ posting.m_page };
+            qsizetype previous = 0;
+            for (const auto position : posting.m_positions) {
+                entry.append(position - previous);
+                previous = position;
+            }
+            postings.append(entry);
+        }
+        shards[shardName(it.key())].insert(it.key(), postings);
+    }
+    for (auto it = shards.cbegin(); it != shards.cend(); ++it) {
+        if (!writeFile(dir.filePath(it.key() + ".json"_L1),
+                       QJsonDocument(it.value()).toJson(QJsonDocument::Compact), errorString)) {
+            return false;
+        }
+    }
+
+    return writeFile(dir.filePath("search.js"_L1), QByteArray(searchLoader), errorString);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,51 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef SEARCHINDEXWRITER_H
+#define SEARCHINDEXWRITER_H
+
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+
+QT_BEGIN_NAMESPACE
+
+class SearchIndexWriter
+{
+public:
+    struct Posting
+    {
+        qsizetype m_page {};
+        QList<qsizetype> m_positions {};
+    };
+
+    void addPage(const QString &fileName, const QString &title, const QStringList &keywords,
+                 const QString &text);
+    bool generate(const QString &outputDir, QString *errorString = nullptr) const;
+    void clear();
+
+    [[nodiscard]] qsizetype pageCount() const { return m_pages.size(); }
+    [[nodiscard]] QList<Posting> postings(const QString &term) const
+    {
+        return m_postings.value(term);
+    }
+
+    static QStringList tokenize(const QString &text);
+    static QString shardName(const QString &term);
+
+private:
+    struct Page
+    {
+        QString m_fileName {};
+        QString m_title {};
+        qsizetype m_headerLength {};
+    };
+
+    QList<Page> m_pages {};
+    QHash<QString, QList<Posting>> m_postings {};
+};
+
+QT_END_NAMESPACE
+
+#endif // SEARCHINDEXWRITER_H
@@ -21,7 +21,7 @@
 
 QT_BEGIN_NAMESPACE
 
-QList<Section> Sections::s_stdSummarySections {
+const QList<Section> Sections::s_stdSummarySections {
     { "Namespaces",       "namespace",       "namespaces",       "", Section::Summary },
     { "Classes",          "class",           "classes",          "", Section::Summary },
     { "Types",            "type",            "types",            "", Section::Summary },
@@ -31,7 +31,7 @@ QList<Section> Sections::s_stdSummarySections {
     { "Macros",           "macro",           "macros",           "", Section::Summary },
 };
 
-QList<Section> Sections::s_stdDetailsSections {
+const QList<Section> Sections::s_stdDetailsSections {
     { "Namespaces",             "namespace",       "namespaces",       "nmspace", Section::Details },
     { "Classes",                "class",           "classes",          "classes", Section::Details },
     { "Type Documentation",     "type",            "types",            "types",   Section::Details },
@@ -41,7 +41,7 @@ QList<Section> Sections::s_stdDetailsSections {
     { "Macro Documentation",    "macro",           "macros",           "macros",  Section::Details },
 };
 
-QList<Section> Sections::s_stdCppClassSummarySections {
+const QList<Section> Sections::s_stdCppClassSummarySections {
     { "Public Types",             "public type",             "public types",             "", Section::Summary },
     { "Properties",               "property",                "properties",               "", Section::Summary },
     { "Public Functions",         "public function",         "public functions",         "", Section::Summary },
@@ -62,7 +62,7 @@ QList<Section> Sections::s_stdCppClassSummarySections {
     { "Macros",                   "macro",                   "macros",                   "", Section::Summary },
 };
 
-QList<Section> Sections::s_stdCppClassDetailsSections {
+const QList<Section> Sections::s_stdCppClassDetailsSections {
     { "Member Type Documentation",     "member", "members", "types",     Section::Details },
     { "Property Documentation",        "member", "members", "prop",      Section::Details },
     { "Member Function Documentation", "member", "members", "func",      Section::Details },
@@ -71,7 +71,7 @@ QList<Section> Sections::s_stdCppClassDetailsSections {
     { "Macro Documentation",           "member", "members", "macros",    Section::Details },
 };
 
-QList<Section> Sections::s_stdQmlTypeSummarySections {
+const QList<Section> Sections::s_stdQmlTypeSummarySections {
     { "Properties",          "property",          "properties",          "", Section::Summary },
     { "Attached Properties", "attached property", "attached properties", "", Section::Summary },
     { "Signals",             "signal",            "signals",             "", Section::Summary },
@@ -81,7 +81,7 @@ QList<Section> Sections::s_stdQmlTypeSummarySections {
     { "Attached Methods",    "attached method",   "attached methods",    "", Section::Summary },
 };
 
-QList<Section> Sections::s_stdQmlTypeDetailsSections {
+const QList<Section> Sections::s_stdQmlTypeDetailsSections {
     { "Property Documentation",          "member",         "members",         "qmlprop",    Section::Details },
     { "Attached Property Documentation", "member",         "members",         "qmlattprop", Section::Details },
     { "Signal Documentation",            "signal",         "signals",         "qmlsig",     Section::Details },
@@ -91,7 +91,7 @@ QList<Section> Sections::s_stdQmlTypeDetailsSections {
     { "Attached Method Documentation",   "member",         "members",         "qmlattmeth", Section::Details },
 };
 
-QList<Section> Sections::s_sinceSections {
+const QList<Section> Sections::s_sinceSections {
     { "New Namespaces",              "", "", "", Section::Details },
     { "New Classes",                 "", "", "", Section::Details },
     { "New Member Functions",        "", "", "", Section::Details },
@@ -110,7 +110,9 @@ QList<Section> Sections::s_sinceSections {
     { "New QML Methods",             "", "", "", Section::Details },
 };
 
-QList<Section> Sections::s_allMembers{ { "", "member", "members", "", Section::AllMembers } };
+const QList<Section> Sections::s_allMembers{ { "", "member", "members", "", Section::AllMembers } };
+
+QHash<const Aggregate *, Sections *> Sections::s_cache;
 
 /*!
   \class Section
@@ -127,10 +129,7 @@ Section::~Section()
 }
 
 /*!
-  A Section is now an element in a static vector, so we
-  don't have to repeatedly construct and destroy them. But
-  we do need to clear them before each call to build the
-  sections for a C++ or QML entity.
+  Reset the section to its initialized state.
  */
 void Section::clear()
 {
@@ -343,27 +342,27 @@ void Section::reduce()
  */
 Sections::Sections(Aggregate *aggregate) : m_aggregate(aggregate)
 {
-    initAggregate(s_allMembers, m_aggregate);
+    initAggregate(m_allMembers, m_aggregate);
     switch (m_aggregate->nodeType()) {
     case Node::Class:
     case Node::Struct:
     case Node::Union:
-        initAggregate(s_stdCppClassSummarySections, m_aggregate);
-        initAggregate(s_stdCppClassDetailsSections, m_aggregate);
+        initAggregate(m_stdCppClassSummarySections, m_aggregate);
+        initAggregate(m_stdCppClassDetailsSections, m_aggregate);
         buildStdCppClassRefPageSections();
         break;
     case Node::QmlType:
     case Node::QmlValueType:
-        initAggregate(s_stdQmlTypeSummarySections, m_aggregate);
-        initAggregate(s_stdQmlTypeDetailsSections, m_aggregate);
+        initAggregate(m_stdQmlTypeSummarySections, m_aggregate);
+        initAggregate(m_stdQmlTypeDetailsSections, m_aggregate);
         buildStdQmlTypeRefPageSections();
         break;
     case Node::Namespace:
     case Node::HeaderFile:
     case Node::Proxy:
     default:
-        initAggregate(s_stdSummarySections, m_aggregate);
-        initAggregate(s_stdDetailsSections, m_aggregate);
+        initAggregate(m_stdSummarySections, m_aggregate);
+        initAggregate(m_stdDetailsSections, m_aggregate);
         buildStdRefPageSections();
         break;
     }
@@ -455,39 +454,36 @@ Sections::Sections(const NodeMultiMap &nsmap) : m_aggregate(nullptr)
     }
 }
 
+Sections::~Sections() = default;
+
 /*!
-  The behavior of the destructor depends on the type of the
-  Aggregate node that was passed to the constructor. If the
-  constructor was passed a multimap, the destruction is a
-  bit different because there was no Aggregate node.
+  Returns the sections for the reference page of \a aggregate.
+
+  The sections are built the first time they are requested for
+  \a aggregate, which happens during the generate phase, after
+  all references are resolved. They are then kept, unmodified,
+  so that the reference page, the member listing pages, and all
+  output formats share a single instance instead of walking the
+  aggregate, its base types and its related nodes again.
+
+  The cached sections are discarded by clearCache().
  */
-Sections::~Sections()
+const Sections &Sections::forAggregate(Aggregate *aggregate)
 {
-    if (m_aggregate) {
-        switch (m_aggregate->nodeType()) {
-        case Node::Class:
-        case Node::Struct:
-        case Node::Union:
-            clear(stdCppClassSummarySections());
-            clear(stdCppClassDetailsSections());
-            allMembersSection().clear();
-            break;
-        case Node::QmlType:
-        case Node::QmlValueType:
-            clear(stdQmlTypeSummarySections());
-            clear(stdQmlTypeDetailsSections());
-            allMembersSection().clear();
-            break;
-        default:
-            clear(stdSummarySections());
-            clear(stdDetailsSections());
-            allMembersSection().clear();
-            break;
-        }
-        m_aggregate = nullptr;
-    } else {
-        clear(sinceSections());
-    }
+    Sections *&sections = s_cache[aggregate];
+    if (!sections)
+        sections = new Sections(aggregate);
+    return *sections;
+}
+
+/*!
+  Deletes all sections built by forAggregate(). This must be
+  called before the nodes they refer to are destroyed.
+ */
+void Sections::clearCache()
+{
+    qDeleteAll(s_cache);
+    s_cache.clear();
 }
 
 /*!
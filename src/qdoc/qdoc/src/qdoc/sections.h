@@ -6,6 +6,8 @@
 
 #include "node.h"
 
+#include <QtCore/qhash.h>
+
 QT_BEGIN_NAMESPACE
 
 class Aggregate;
@@ -53,6 +55,7 @@ public:
         return m_inheritedMembers;
     }
     ClassNodesList &classNodesList() { return m_classNodesList; }
+    [[nodiscard]] const ClassNodesList &classNodesList() const { return m_classNodesList; }
     [[nodiscard]] const NodeVector &obsoleteMembers() const { return m_obsoleteMembers; }
     void appendMembers(const NodeVector &nv) { m_members.append(nv); }
     [[nodiscard]] const Aggregate *aggregate() const { return m_aggregate; }
@@ -142,6 +145,9 @@ public:
     explicit Sections(const NodeMultiMap &nsmap);
     ~Sections();
 
+    static const Sections &forAggregate(Aggregate *aggregate);
+    static void clearCache();
+
     void clear(SectionVector &v);
     void reduce(SectionVector &v);
     void buildStdRefPageSections();
@@ -150,32 +156,34 @@ public:
 
     bool hasObsoleteMembers(SectionPtrVector *summary_spv, SectionPtrVector *details_spv) const;
 
-    static Section &allMembersSection() { return s_allMembers[0]; }
-    SectionVector &sinceSections() { return s_sinceSections; }
-    SectionVector &stdSummarySections() { return s_stdSummarySections; }
-    SectionVector &stdDetailsSections() { return s_stdDetailsSections; }
-    SectionVector &stdCppClassSummarySections() { return s_stdCppClassSummarySections; }
-    SectionVector &stdCppClassDetailsSections() { return s_stdCppClassDetailsSections; }
-    SectionVector &stdQmlTypeSummarySections() { return s_stdQmlTypeSummarySections; }
-    SectionVector &stdQmlTypeDetailsSections() { return s_stdQmlTypeDetailsSections; }
-
-    [[nodiscard]] const SectionVector &stdSummarySections() const { return s_stdSummarySections; }
-    [[nodiscard]] const SectionVector &stdDetailsSections() const { return s_stdDetailsSections; }
+    Section &allMembersSection() { return m_allMembers[0]; }
+    SectionVector &sinceSections() { return m_sinceSections; }
+    SectionVector &stdSummarySections() { return m_stdSummarySections; }
+    SectionVector &stdDetailsSections() { return m_stdDetailsSections; }
+    SectionVector &stdCppClassSummarySections() { return m_stdCppClassSummarySections; }
+    SectionVector &stdCppClassDetailsSections() { return m_stdCppClassDetailsSections; }
+    SectionVector &stdQmlTypeSummarySections() { return m_stdQmlTypeSummarySections; }
+    SectionVector &stdQmlTypeDetailsSections() { return m_stdQmlTypeDetailsSections; }
+
+    [[nodiscard]] const Section &allMembersSection() const { return m_allMembers[0]; }
+    [[nodiscard]] const SectionVector &sinceSections() const { return m_sinceSections; }
+    [[nodiscard]] const SectionVector &stdSummarySections() const { return m_stdSummarySections; }
+    [[nodiscard]] const SectionVector &stdDetailsSections() const { return m_stdDetailsSections; }
     [[nodiscard]] const SectionVector &stdCppClassSummarySections() const
     {
-        return s_stdCppClassSummarySections;
+        return m_stdCppClassSummarySections;
     }
     [[nodiscard]] const SectionVector &stdCppClassDetailsSections() const
     {
-        return s_stdCppClassDetailsSections;
+        return m_stdCppClassDetailsSections;
     }
     [[nodiscard]] const SectionVector &stdQmlTypeSummarySections() const
     {
-        return s_stdQmlTypeSummarySections;
+        return m_stdQmlTypeSummarySections;
     }
     [[nodiscard]] const SectionVector &stdQmlTypeDetailsSections() const
     {
-        return s_stdQmlTypeDetailsSections;
+        return m_stdQmlTypeDetailsSections;
     }
 
     [[nodiscard]] Aggregate *aggregate() const { return m_aggregate; }
@@ -191,14 +199,25 @@ private:
 private:
     Aggregate *m_aggregate { nullptr };
 
-    static SectionVector s_stdSummarySections;
-    static SectionVector s_stdDetailsSections;
-    static SectionVector s_stdCppClassSummarySections;
-    static SectionVector s_stdCppClassDetailsSections;
-    static SectionVector s_stdQmlTypeSummarySections;
-    static SectionVector s_stdQmlTypeDetailsSections;
-    static SectionVector s_sinceSections;
-    static SectionVector s_allMembers;
+    SectionVector m_stdSummarySections = s_stdSummarySections;
+    SectionVector m_stdDetailsSections = s_stdDetailsSections;
+    SectionVector m_stdCppClassSummarySections = s_stdCppClassSummarySections;
+    SectionVector m_stdCppClassDetailsSections = s_stdCppClassDetailsSections;
+    SectionVector m_stdQmlTypeSummarySections = s_stdQmlTypeSummarySections;
+    SectionVector m_stdQmlTypeDetailsSections = s_stdQmlTypeDetailsSections;
+    SectionVector m_sinceSections = s_sinceSections;
+    SectionVector m_allMembers = s_allMembers;
+
+    static QHash<const Aggregate *, Sections *> s_cache;
+
+    static const SectionVector s_stdSummarySections;
+    static const SectionVector s_stdDetailsSections;
+    static const SectionVector s_stdCppClassSummarySections;
+    static const SectionVector s_stdCppClassDetailsSections;
+    static const SectionVector s_stdQmlTypeSummarySections;
+    static const SectionVector s_stdQmlTypeDetailsSections;
+    static const SectionVector s_sinceSections;
+    static const SectionVector s_allMembers;
 };
 
 QT_END_NAMESPACE
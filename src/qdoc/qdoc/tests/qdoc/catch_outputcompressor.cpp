@@ -0,0 +1,118 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <catch_conversions/qdoc_catch_conversions.h>
+
+#include <catch/catch.hpp>
+
+#include <qdoc/outputcompressor.h>
+
+#include <QFile>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+// Rewraps the deflate payload of a gzip member in the format expected
+// by qUncompress(), so that it can be verified without zlib. The
+// Adler-32 checksum is computed from the \a expected contents, as
+// qUncompress() rejects the stream if it doesn't match.
+static QByteArray uncompressAs(const QByteArray &gzipped, const QByteArray &expected)
+{
+    quint32 a = 1, b = 0;
+    for (const char ch : expected) {
+        a = (a + quint8(ch)) % 65521;
+        b = (b + a) % 65521;
+    }
+
+    QByteArray zlib(4, Qt::Uninitialized);
+    qToBigEndian<quint32>(quint32(expected.size()), zlib.data());
+    zlib.append("\x78\xda", 2);
+    zlib.append(gzipped.mid(10, gzipped.size() - 18));
+    zlib.append(4, '\0');
+    qToBigEndian<quint32>((b << 16) | a, zlib.data() + zlib.size() - 4);
+    return qUncompress(zlib);
+}
+
+SCENARIO("Compressing a generated page", "[OutputCompressor][Precompress]") {
+    GIVEN("The contents of a page") {
+        const QByteArray contents = QByteArray("<html><body>").repeated(100)
+                + "<p>Some text</p>\n" + QByteArray("</body></html>").repeated(100);
+
+        WHEN("The contents are compressed in gzip format") {
+            const QByteArray gzipped = OutputCompressor::gzip(contents);
+
+            THEN("The result starts with the gzip magic number") {
+                REQUIRE(gzipped.startsWith("\x1f\x8b\x08"));
+            }
+
+            THEN("The result is smaller than the contents") {
+                REQUIRE(gzipped.size() < contents.size());
+            }
+
+            THEN("The trailer records the checksum and size of the contents") {
+                const char *trailer = gzipped.constData() + gzipped.size() - 8;
+                REQUIRE(qFromLittleEndian<quint32>(trailer) == OutputCompressor::crc32(contents));
+                REQUIRE(qFromLittleEndian<quint32>(trailer + 4) == quint32(contents.size()));
+            }
+
+            THEN("The payload decompresses to the contents") {
+                REQUIRE(uncompressAs(gzipped, contents) == contents);
+            }
+        }
+    }
+
+    GIVEN("A known input") {
+        THEN("Its CRC-32 matches the reference value") {
+            REQUIRE(OutputCompressor::crc32("123456789") == 0xcbf43926U);
+        }
+    }
+}
+
+SCENARIO("Writing precompressed siblings", "[OutputCompressor][Precompress]") {
+    GIVEN("A page in an output directory") {
+        QTemporaryDir working_directory{};
+        REQUIRE(working_directory.isValid());
+
+        const QString page = working_directory.filePath("page.html");
+        const QByteArray contents = QByteArray("<p>Lorem ipsum</p>\n").repeated(50);
+
+        WHEN("The page is handed to a compressor") {
+            OutputCompressor compressor;
+            compressor.compress(page, contents);
+
+            THEN("A .gz sibling is written without errors") {
+                REQUIRE(compressor.waitForDone().isEmpty());
+
+                QFile gz(page + ".gz");
+                REQUIRE(gz.open(QIODevice::ReadOnly));
+                REQUIRE(gz.readAll() == OutputCompressor::gzip(contents));
+            }
+
+            AND_WHEN("The same contents are compressed again") {
+                REQUIRE(compressor.waitForDone().isEmpty());
+                const QDateTime modified = QFileInfo(page + ".gz").lastModified();
+
+                THEN("The existing sibling is considered up to date") {
+                    REQUIRE(OutputCompressor::isUpToDate(page + ".gz",
+                                                         OutputCompressor::crc32(contents),
+                                                         contents.size()));
+                    compressor.compress(page, contents);
+                    REQUIRE(compressor.waitForDone().isEmpty());
+                    REQUIRE(QFileInfo(page + ".gz").lastModified() == modified);
+                }
+            }
+
+            AND_WHEN("The contents change") {
+                REQUIRE(compressor.waitForDone().isEmpty());
+                const QByteArray changed = contents + "<p>More</p>\n";
+
+                THEN("The existing sibling is outdated") {
+                    REQUIRE(!OutputCompressor::isUpToDate(page + ".gz",
+                                                          OutputCompressor::crc32(changed),
+                                                          changed.size()));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,101 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <catch_conversions/qdoc_catch_conversions.h>
+
+#include <catch/catch.hpp>
+
+#include <qdoc/qchwriter.h>
+
+#include <QDataStream>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+// Runs \a statement on the help file \a filePath and returns the
+// first column of the first row.
+static QVariant queryValue(const QString &filePath, const QString &statement)
+{
+    QVariant result;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "catch_qchwriter");
+        db.setDatabaseName(filePath);
+        REQUIRE(db.open());
+        QSqlQuery query(db);
+        REQUIRE(query.exec(statement));
+        if (query.next())
+            result = query.value(0);
+    }
+    QSqlDatabase::removeDatabase("catch_qchwriter");
+    return result;
+}
+
+SCENARIO("Writing a compressed help file", "[QchWriter][Qch]") {
+    GIVEN("An open help file") {
+        QTemporaryDir working_directory{};
+        REQUIRE(working_directory.isValid());
+        const QString qch = working_directory.filePath("project.qch");
+
+        QchWriter writer;
+        REQUIRE(writer.open(qch, "org.qt-project.test", "test", { "test", "qt" }));
+
+        const QByteArray page = "<html><head><title>Page</title></head></html>";
+
+        WHEN("A page, a keyword, and the contents are added") {
+            REQUIRE(writer.addFile("page.html", "Page", page));
+            writer.addKeyword("Keyword", "keyword-id", "page.html#anchor");
+
+            QByteArray contents;
+            QDataStream stream(&contents, QIODevice::WriteOnly);
+            stream << 0 << QString("page.html") << QString("Page");
+            REQUIRE(writer.addContents(contents));
+
+            REQUIRE(writer.close());
+
+            THEN("The page is stored compressed, with its title") {
+                REQUIRE(queryValue(qch, "SELECT Title FROM FileNameTable WHERE Name='page.html'")
+                                .toString()
+                        == "Page");
+                const QByteArray stored = queryValue(
+                        qch,
+                        "SELECT Data FROM FileDataTable, FileNameTable "
+                        "WHERE FileDataTable.Id=FileNameTable.FileId AND Name='page.html'")
+                                                  .toByteArray();
+                REQUIRE(qUncompress(stored) == page);
+            }
+
+            THEN("The keyword refers to the page and its anchor") {
+                REQUIRE(queryValue(qch,
+                                   "SELECT Name FROM FileNameTable, IndexTable "
+                                   "WHERE FileNameTable.FileId=IndexTable.FileId "
+                                   "AND Identifier='keyword-id'")
+                                .toString()
+                        == "page.html");
+                REQUIRE(queryValue(qch, "SELECT Anchor FROM IndexTable").toString() == "anchor");
+            }
+
+            THEN("The page and the keyword are associated with every filter attribute") {
+                REQUIRE(queryValue(qch, "SELECT COUNT(*) FROM FilterAttributeTable").toInt() == 2);
+                REQUIRE(queryValue(qch, "SELECT COUNT(*) FROM IndexFilterTable").toInt() == 2);
+                REQUIRE(queryValue(qch, "SELECT COUNT(*) FROM FileFilterTable").toInt() == 2);
+            }
+
+            THEN("The contents are stored for the namespace") {
+                REQUIRE(queryValue(qch, "SELECT Data FROM ContentsTable").toByteArray()
+                        == contents);
+            }
+        }
+
+        WHEN("The same page is added twice") {
+            REQUIRE(writer.addFile("page.html", "Page", page));
+            REQUIRE(writer.addFile("./page.html", "Page", page));
+            REQUIRE(writer.close());
+
+            THEN("It is stored once") {
+                REQUIRE(queryValue(qch, "SELECT COUNT(*) FROM FileNameTable WHERE Name='page.html'")
+                                .toInt()
+                        == 1);
+            }
+        }
+    }
+}
@@ -0,0 +1,90 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <catch_conversions/qdoc_catch_conversions.h>
+
+#include <catch/catch.hpp>
+
+#include <qdoc/searchindexwriter.h>
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+SCENARIO("Tokenizing page text for the search index", "[SearchIndex]") {
+    GIVEN("Some text with punctuation, mixed case and short words") {
+        const QString text{"QString::arg() takes a Value, and returns QString_view."};
+
+        WHEN("The text is tokenized") {
+            const QStringList terms = SearchIndexWriter::tokenize(text);
+
+            THEN("Words are lowercased, split at punctuation and single characters are dropped") {
+                REQUIRE(terms == QStringList{ "qstring", "arg", "takes", "value", "and", "returns",
+                                              "qstring_view" });
+            }
+        }
+    }
+
+    GIVEN("Terms starting with different characters") {
+        THEN("ASCII letters and digits get their own shard and everything else shares one") {
+            REQUIRE(SearchIndexWriter::shardName("qstring") == "index-q");
+            REQUIRE(SearchIndexWriter::shardName("3d") == "index-3");
+            REQUIRE(SearchIndexWriter::shardName("_private") == "index-_");
+            REQUIRE(SearchIndexWriter::shardName(QString::fromUtf8("\xc3\xa9t\xc3\xa9"))
+                    == "index-_");
+        }
+    }
+}
+
+SCENARIO("Building the search index page by page", "[SearchIndex]") {
+    GIVEN("An index with two pages") {
+        SearchIndexWriter writer;
+        writer.addPage("qstring.html", "QString Class", { "unicode" }, "Text with text.");
+        writer.addPage("qbytearray.html", "QByteArray Class", {}, "Bytes, not text.");
+
+        THEN("Each term records the pages and positions it occurs at") {
+            REQUIRE(writer.pageCount() == 2);
+
+            const auto postings = writer.postings("text");
+            REQUIRE(postings.size() == 2);
+            REQUIRE(postings.at(0).m_page == 0);
+            REQUIRE(postings.at(0).m_positions == QList<qsizetype>{ 3, 5 });
+            REQUIRE(postings.at(1).m_page == 1);
+            REQUIRE(postings.at(1).m_positions == QList<qsizetype>{ 4 });
+        }
+
+        WHEN("The index is written to an output directory") {
+            QTemporaryDir output_directory{};
+            REQUIRE(output_directory.isValid());
+
+            QString errorString;
+            REQUIRE(writer.generate(output_directory.path(), &errorString));
+            const QDir search{output_directory.filePath("search")};
+
+            THEN("The page table lists file names, titles and header lengths") {
+                QFile pages{search.filePath("pages.json")};
+                REQUIRE(pages.open(QIODevice::ReadOnly));
+                const QJsonArray table = QJsonDocument::fromJson(pages.readAll()).array();
+                REQUIRE(table.size() == 2);
+                REQUIRE(table.at(0).toArray().at(0).toString() == "qstring.html");
+                REQUIRE(table.at(0).toArray().at(2).toInteger() == 3);
+            }
+
+            THEN("Postings are stored in the shard of their term with delta-encoded positions") {
+                QFile shard{search.filePath("index-t.json")};
+                REQUIRE(shard.open(QIODevice::ReadOnly));
+                const QJsonObject terms = QJsonDocument::fromJson(shard.readAll()).object();
+                const QJsonArray first = terms.value("text").toArray().at(0).toArray();
+                REQUIRE(first == QJsonArray{ 0, 3, 2 });
+                REQUIRE(!terms.contains("qstring"));
+            }
+
+            THEN("The loader is written next to the index") {
+                REQUIRE(QFile::exists(search.filePath("search.js")));
+            }
+        }
+    }
+}
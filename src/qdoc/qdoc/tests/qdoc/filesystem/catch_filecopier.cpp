@@ -0,0 +1,104 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <catch_conversions/qdoc_catch_conversions.h>
+
+#include <catch/catch.hpp>
+
+#include <qdoc/filesystem/filecopier.h>
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+static void write_file(const QString& path, const QByteArray& contents)
+{
+    QFile file{path};
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    REQUIRE(file.write(contents) == contents.size());
+}
+
+static QByteArray read_file(const QString& path)
+{
+    QFile file{path};
+    REQUIRE(file.open(QIODevice::ReadOnly));
+    return file.readAll();
+}
+
+SCENARIO("Copying files into an output directory", "[FileCopier][Copy]") {
+    GIVEN("A source file and a target path in an existing directory") {
+        QTemporaryDir working_directory{};
+        REQUIRE(working_directory.isValid());
+
+        const QString source = working_directory.filePath("image.png");
+        const QString target = working_directory.filePath("copy.png");
+        write_file(source, "not really an image");
+
+        FileCopier copier{};
+
+        WHEN("A copy is requested") {
+            REQUIRE(copier.copy(source, target));
+
+            THEN("The target has the contents of the source once the copier is done") {
+                REQUIRE(copier.wait_for_done().isEmpty());
+                REQUIRE(read_file(target) == read_file(source));
+            }
+
+            AND_WHEN("The same copy is requested again") {
+                THEN("The request is ignored") {
+                    REQUIRE_FALSE(copier.copy(source, target));
+                    REQUIRE(copier.wait_for_done().isEmpty());
+                }
+            }
+
+            AND_WHEN("The same target is requested from a different source") {
+                const QString other_source = working_directory.filePath("other.png");
+                write_file(other_source, "another image");
+
+                REQUIRE(copier.copy(other_source, target));
+
+                THEN("The target has the contents of the last source") {
+                    REQUIRE(copier.wait_for_done().isEmpty());
+                    REQUIRE(read_file(target) == "another image");
+                }
+            }
+        }
+
+        WHEN("The target was copied by a previous run") {
+            REQUIRE(copier.copy(source, target));
+            REQUIRE(copier.wait_for_done().isEmpty());
+
+            THEN("The target is up to date") {
+                REQUIRE(FileCopier::is_up_to_date(source, target));
+            }
+
+            AND_WHEN("The copy is requested again") {
+                const QDateTime modified = QFileInfo(target).lastModified();
+                REQUIRE(copier.copy(source, target));
+                REQUIRE(copier.wait_for_done().isEmpty());
+
+                THEN("The target is left untouched") {
+                    REQUIRE(QFileInfo(target).lastModified() == modified);
+                }
+            }
+
+            AND_WHEN("The source changes size") {
+                write_file(source, "a bigger image than before");
+
+                THEN("The target is outdated") {
+                    REQUIRE_FALSE(FileCopier::is_up_to_date(source, target));
+                }
+            }
+        }
+
+        WHEN("A copy is requested from a source that does not exist") {
+            REQUIRE(copier.copy(working_directory.filePath("missing.png"), target));
+
+            THEN("An error is reported once the copier is done") {
+                REQUIRE(copier.wait_for_done().size() == 1);
+                REQUIRE_FALSE(QFileInfo::exists(target));
+            }
+        }
+    }
+}
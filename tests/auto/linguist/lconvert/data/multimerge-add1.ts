@@ -0,0 +1,25 @@
+<?xml version="1.0" encoding="utf-8"?>
+<!DOCTYPE TS>
+<TS version="2.1" language="de_DE">
+<context>
+    <name>A</name>
+    <message>
+        <location filename="a.cpp" line="25"/>
+        <source>Delta</source>
+        <translation></translation>
+    </message>
+    <message>
+        <location filename="c.cpp" line="3"/>
+        <source>Beta</source>
+        <translation>Beta</translation>
+    </message>
+</context>
+<context>
+    <name>B</name>
+    <message id="b_one">
+        <location filename="b.cpp" line="7"/>
+        <source>One, changed</source>
+        <translation>Eins</translation>
+    </message>
+</context>
+</TS>
@@ -0,0 +1,33 @@
+<?xml version="1.0" encoding="utf-8"?>
+<!DOCTYPE TS>
+<TS version="2.1" language="de_DE">
+<context>
+    <name>A</name>
+    <message>
+        <location filename="a.cpp" line="22"/>
+        <source>Epsilon</source>
+        <translation></translation>
+    </message>
+</context>
+<context>
+    <name>C</name>
+    <message id="b_two">
+        <location filename="b.cpp" line="15"/>
+        <source>Two</source>
+        <translation>Zwei</translation>
+    </message>
+    <message>
+        <location filename="b.cpp" line="16"/>
+        <source>Three</source>
+        <translation></translation>
+    </message>
+</context>
+<context>
+    <name>A</name>
+    <message>
+        <location filename="a.cpp" line="5"/>
+        <source>Zeta</source>
+        <translation></translation>
+    </message>
+</context>
+</TS>
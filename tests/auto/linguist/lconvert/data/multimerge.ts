@@ -0,0 +1,35 @@
+<?xml version="1.0" encoding="utf-8"?>
+<!DOCTYPE TS>
+<TS version="2.1" language="de_DE">
+<context>
+    <name>A</name>
+    <message>
+        <location filename="a.cpp" line="10"/>
+        <source>Alpha</source>
+        <translation></translation>
+    </message>
+    <message>
+        <location filename="a.cpp" line="20"/>
+        <source>Beta</source>
+        <translation></translation>
+    </message>
+    <message>
+        <location filename="a.cpp" line="30"/>
+        <source>Gamma</source>
+        <translation></translation>
+    </message>
+</context>
+<context>
+    <name>B</name>
+    <message id="b_one">
+        <location filename="b.cpp" line="5"/>
+        <source>One</source>
+        <translation></translation>
+    </message>
+    <message id="b_two">
+        <location filename="b.cpp" line="15"/>
+        <source>Two</source>
+        <translation></translation>
+    </message>
+</context>
+</TS>
@@ -20,12 +20,15 @@ private slots:
     void initTestCase();
     void readverifies_data();
     void readverifies();
+    void readfails_data();
+    void readfails();
     void converts_data();
     void converts();
     void roundtrips_data();
     void roundtrips();
     void chains_data();
     void chains();
+    void merge_data();
     void merge();
 
 private:
@@ -240,6 +243,21 @@ void tst_lconvert::readverifies()
     convertRoundtrip(fileName, QStringList() << format << format, QList<QStringList>());
 }
 
+void tst_lconvert::readfails_data()
+{
+    QTest::addColumn<QString>("fileName");
+
+    // Only the source text of the first message is broken
+    QTest::newRow("qm broken utf8") << "test-broken-utf8.qm";
+}
+
+void tst_lconvert::readfails()
+{
+    QFETCH(QString, fileName);
+
+    verifyReadFail(fileName);
+}
+
 void tst_lconvert::converts_data()
 {
     QTest::addColumn<QString>("inFileName");
@@ -356,15 +374,34 @@ void tst_lconvert::roundtrips()
     convertRoundtrip(fileName, stations, args);
 }
 
+void tst_lconvert::merge_data()
+{
+    QTest::addColumn<QStringList>("inFileNames");
+    QTest::addColumn<QString>("outFileName");
+
+    QTest::newRow("index") << QStringList({ "idxmerge.ts", "idxmerge-add.ts" })
+                           << "idxmerge.ts.out";
+    // The expected output is that of merging one message after the other.
+    // It covers messages that are replaced by id, and replaced messages
+    // that move to another file or context.
+    QTest::newRow("multiple files")
+            << QStringList({ "multimerge.ts", "multimerge-add1.ts", "multimerge-add2.ts" })
+            << "multimerge.ts.out";
+}
+
 void tst_lconvert::merge()
 {
+    QFETCH(QStringList, inFileNames);
+    QFETCH(QString, outFileName);
+
     QProcess cvt;
     QStringList args;
-    args << (dataDir + "idxmerge.ts") << (dataDir + "idxmerge-add.ts");
+    for (const QString &inFileName : std::as_const(inFileNames))
+        args << (dataDir + inFileName);
     cvt.start(lconvert, args, QIODevice::ReadWrite | QIODevice::Text);
     doWait(&cvt, 1);
     if (!QTest::currentTestFailed())
-        doCompare(&cvt, dataDir + "idxmerge.ts.out");
+        doCompare(&cvt, dataDir + outFileName);
 }
 
 QTEST_APPLESS_MAIN(tst_lconvert)
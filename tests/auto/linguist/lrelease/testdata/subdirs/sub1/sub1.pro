@@ -0,0 +1 @@
+TRANSLATIONS = sub1.ts
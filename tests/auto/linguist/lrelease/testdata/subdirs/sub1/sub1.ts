@@ -0,0 +1,11 @@
+<?xml version="1.0" encoding="utf-8"?>
+<!DOCTYPE TS>
+<TS version="2.1" language="de">
+<context>
+    <name>Context</name>
+    <message>
+        <source>Project</source>
+        <translation>sub1</translation>
+    </message>
+</context>
+</TS>
@@ -0,0 +1 @@
+TRANSLATIONS = a.ts
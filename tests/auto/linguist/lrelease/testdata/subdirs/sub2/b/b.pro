@@ -0,0 +1 @@
+TRANSLATIONS = b.ts
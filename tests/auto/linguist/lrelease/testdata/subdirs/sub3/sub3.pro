@@ -0,0 +1 @@
+TRANSLATIONS = sub3.ts
@@ -27,6 +27,8 @@ private slots:
     void markuntranslated();
     void dupes();
     void noTranslations();
+    void threads();
+    void projectThreads();
 
 private:
     void doCompare(const QStringList &actual, const QString &expectedFn);
@@ -194,5 +196,75 @@ void tst_lrelease::noTranslations()
     QVERIFY(stderrOutput.contains("lrelease warning: Met no 'TRANSLATIONS' entry in project file"));
 }
 
+void tst_lrelease::threads()
+{
+    const QStringList tsFiles = { "compressed.ts", "dupes.ts", "translate.ts" };
+    QStringList args = { "-j", "3" };
+    for (const QString &tsFile : tsFiles)
+        args << dataDir + tsFile;
+
+    QProcess proc;
+    proc.start(lrelease, args, QIODevice::ReadWrite | QIODevice::Text);
+    QVERIFY(proc.waitForFinished());
+    QCOMPARE(proc.exitStatus(), QProcess::NormalExit);
+    QCOMPARE(proc.exitCode(), 0);
+    doCompare(QString(proc.readAllStandardError()).trimmed().split('\n'), dataDir + "dupes.errors");
+
+    // The output about each file comes in the order of the files.
+    QStringList updated;
+    const QStringList lines = QString(proc.readAllStandardOutput()).split('\n');
+    for (const QString &line : lines) {
+        if (line.startsWith("Updating '"))
+            updated << QFileInfo(line.section('\'', 1, 1)).completeBaseName();
+    }
+    QCOMPARE(updated, QStringList({ "compressed", "dupes", "translate" }));
+
+    QTranslator translator;
+    QVERIFY(translator.load(dataDir + "compressed.qm"));
+    qApp->installTranslator(&translator);
+    QCOMPARE(QCoreApplication::translate("Context1", "Foo"), QString::fromLatin1("in first context"));
+    qApp->removeTranslator(&translator);
+}
+
+void tst_lrelease::projectThreads()
+{
+    const QString projectDir = dataDir + "subdirs/";
+    const QStringList qmFiles = { "sub1/sub1.qm", "sub2/a/a.qm", "sub2/b/b.qm", "sub3/sub3.qm" };
+
+    // Release the subprojects with one thread and with several threads.
+    QByteArray output[2];
+    QList<QByteArray> contents[2];
+    const QStringList threadCounts = { "1", "3" };
+    for (int i = 0; i < 2; ++i) {
+        for (const QString &qmFile : qmFiles)
+            QFile::remove(projectDir + qmFile);
+
+        QProcess proc;
+        proc.setProcessChannelMode(QProcess::MergedChannels);
+        proc.start(lrelease, { "-j", threadCounts.at(i), projectDir + "project.pro" });
+        QVERIFY(proc.waitForFinished());
+        QCOMPARE(proc.exitStatus(), QProcess::NormalExit);
+        QCOMPARE(proc.exitCode(), 0);
+        output[i] = proc.readAll();
+
+        for (const QString &qmFile : qmFiles) {
+            QFile file(projectDir + qmFile);
+            QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(file.fileName()));
+            contents[i] << file.readAll();
+        }
+    }
+
+    // The subprojects are released in the order of SUBDIRS either way.
+    QStringList updated;
+    const QStringList lines = QString(output[1]).split('\n');
+    for (const QString &line : lines) {
+        if (line.startsWith("Updating '"))
+            updated << QFileInfo(line.section('\'', 1, 1)).completeBaseName();
+    }
+    QCOMPARE(updated, QStringList({ "sub1", "a", "b", "sub3" }));
+    QCOMPARE(output[1], output[0]);
+    QCOMPARE(contents[1], contents[0]);
+}
+
 QTEST_MAIN(tst_lrelease)
 #include "tst_lrelease.moc"
@@ -0,0 +1,12 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "object.h"
+
+using namespace Shapes;
+
+void Object::fourth()
+{
+    tr("fourth text");
+    QCoreApplication::translate("Global", "fourth");
+}
@@ -0,0 +1,23 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef OBJECT_H
+#define OBJECT_H
+
+namespace Shapes {
+
+class Object : public QObject
+{
+    Q_OBJECT
+public:
+    void first();
+    void second();
+    void third();
+    void fourth();
+
+    QString name() const { return tr("Object"); }
+};
+
+}
+
+#endif
@@ -0,0 +1,11 @@
+<?xml version="1.0" encoding="utf-8"?>
+<!DOCTYPE TS>
+<TS version="2.1">
+<context>
+    <name>Shared</name>
+    <message>
+        <source>ts</source>
+        <translation>ts</translation>
+    </message>
+</context>
+</TS>
@@ -0,0 +1,10 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtCore/QCoreApplication>
+
+void translate()
+{
+    QCoreApplication::translate("Shared", "cpp");
+    tr("no context");
+}
@@ -0,0 +1,12 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+import QtQuick
+
+Item {
+    function translate() {
+        qsTr("qml text");
+        qsTranslate("Shared", "qml");
+        qsTr();
+    }
+}
@@ -0,0 +1,4 @@
+TEMPLATE = subdirs
+SUBDIRS = sub1 sub2 sub3
+
+TRANSLATIONS = project.ts
@@ -0,0 +1 @@
+SOURCES += main.cpp
@@ -0,0 +1,3 @@
+SOURCES += main.cpp
+
+TRANSLATIONS = sub3.ts
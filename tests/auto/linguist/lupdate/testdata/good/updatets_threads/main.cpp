@@ -0,0 +1,11 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtCore/QCoreApplication>
+
+void update()
+{
+    QCoreApplication::translate("Dialog", "Open");
+    QCoreApplication::translate("Dialog", "Save");
+    QCoreApplication::translate("Dialog", "Close");
+}
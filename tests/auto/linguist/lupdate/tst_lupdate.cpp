@@ -36,6 +36,7 @@ private slots:
     void cleanupTestCase();
     void good_data();
     void good();
+    void extractionCache();
 #if CHECK_SIMTEXTH
     void simtexth();
     void simtexth_data();
@@ -273,7 +274,10 @@ void tst_lupdate::good_data()
         "respfile"_L1, //@lst not supported with the new parser yet (include not properly set in the compile_command.json)
         "cmdline_deeppath"_L1, //no project file, new parser does not support (yet) this way of launching lupdate
         "cmdline_order"_L1, // no project, new parser do not pickup on macro defined but not used. Test not needed for new parser.
-        "cmdline_recurse"_L1 // recursive scan without project file not supported (yet) with the new parser
+        "cmdline_recurse"_L1, // recursive scan without project file not supported (yet) with the new parser
+        "parsecpp_threads"_L1, // -j only applies to the built-in parser
+        "parsemixed_threads"_L1, // -j only applies to the built-in parser
+        "updatets_threads"_L1 // no project file, new parser does not support (yet) this way of launching lupdate
     };
     for (const QString &dir : dirs) {
         if (ignoredTests.contains(dir))
@@ -417,6 +421,54 @@ void tst_lupdate::good()
     }
 }
 
+void tst_lupdate::extractionCache()
+{
+    QTemporaryDir workDir;
+    QVERIFY(workDir.isValid());
+    const QString sourceDir = m_basePath + "good/parsecpp_threads/"_L1;
+    const QStringList sources = { "first.cpp"_L1, "second.cpp"_L1, "third.cpp"_L1,
+                                  "fourth.cpp"_L1, "object.h"_L1 };
+    for (const QString &source : sources)
+        QVERIFY(QFile::copy(sourceDir + source, workDir.filePath(source)));
+
+    const auto runLupdate = [&] {
+        QProcess proc;
+        proc.setWorkingDirectory(workDir.path());
+        proc.setProcessChannelMode(QProcess::MergedChannels);
+        proc.start(m_cmdLupdate,
+                   QStringList{ "-silent"_L1, "-cache-dir"_L1, "cache"_L1 } + sources
+                           + QStringList{ "-ts"_L1, "project.ts"_L1 });
+        if (!proc.waitForStarted() || !proc.waitForFinished(TIMEOUT))
+            return false;
+        return proc.exitStatus() == QProcess::NormalExit && proc.exitCode() == 0;
+    };
+
+    // The first run fills the cache, the second one uses it.
+    QVERIFY(runLupdate());
+    QVERIFY(!QDir(workDir.filePath("cache"_L1)).isEmpty());
+    doCompare(workDir.filePath("project.ts"_L1), sourceDir + "project.ts.result"_L1, false);
+    QVERIFY(QFile::remove(workDir.filePath("project.ts"_L1)));
+    QVERIFY(runLupdate());
+    doCompare(workDir.filePath("project.ts"_L1), sourceDir + "project.ts.result"_L1, false);
+
+    // Changing the header invalidates the entries of the files including it.
+    QFile header(workDir.filePath("object.h"_L1));
+    QVERIFY(header.open(QIODevice::ReadOnly));
+    QByteArray contents = header.readAll();
+    header.close();
+    contents.replace("Q_OBJECT", "Q_DECLARE_TR_FUNCTIONS(Renamed)");
+    QVERIFY(header.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(header.write(contents), contents.size());
+    header.close();
+    QVERIFY(QFile::remove(workDir.filePath("project.ts"_L1)));
+    QVERIFY(runLupdate());
+    QFile ts(workDir.filePath("project.ts"_L1));
+    QVERIFY(ts.open(QIODevice::ReadOnly));
+    contents = ts.readAll();
+    QVERIFY(contents.contains("<name>Renamed</name>"));
+    QVERIFY(!contents.contains("<name>Shapes::Object</name>"));
+}
+
 #if CHECK_SIMTEXTH
 void tst_lupdate::simtexth()
 {
@@ -0,0 +1,132 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <simtexth.h>
+
+#include <QtTest/QtTest>
+#include <QtCore/QRandomGenerator>
+
+using namespace Qt::Literals::StringLiterals;
+
+class tst_bench_simtexth : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void perCandidate_data();
+    void perCandidate();
+    void index_data();
+    void index();
+    void buildIndex_data();
+    void buildIndex();
+
+private:
+    QStringList candidates(int count) const;
+
+    QStringList m_words;
+    QStringList m_queries;
+};
+
+// Builds source texts of a few words each, like the messages of an application.
+static QString sentence(QRandomGenerator &random, const QStringList &words)
+{
+    QStringList sentence;
+    const int length = random.bounded(2, 10);
+    for (int i = 0; i < length; ++i)
+        sentence << words.at(random.bounded(int(words.size())));
+    return sentence.join(u' ');
+}
+
+void tst_bench_simtexth::initTestCase()
+{
+    m_words = u"open save file edit view help close window document print preview "
+              "settings language translation message source phrase book context "
+              "comment error warning could not be found the a of to with"_s.split(u' ');
+    QRandomGenerator random(42);
+    for (int i = 0; i < 16; ++i)
+        m_queries << sentence(random, m_words);
+}
+
+QStringList tst_bench_simtexth::candidates(int count) const
+{
+    QRandomGenerator random(1);
+    QStringList result;
+    result.reserve(count);
+    for (int i = 0; i < count; ++i)
+        result << sentence(random, m_words);
+    return result;
+}
+
+static void addCountRows()
+{
+    QTest::addColumn<int>("count");
+    for (int count : { 1000, 10000, 50000 })
+        QTest::addRow("%d", count) << count;
+}
+
+void tst_bench_simtexth::perCandidate_data()
+{
+    addCountRows();
+}
+
+// Scores every candidate with StringSimilarityMatcher, which constructs the
+// CoMatrix of each candidate again for every query.
+void tst_bench_simtexth::perCandidate()
+{
+    QFETCH(int, count);
+    const QStringList strings = candidates(count);
+    int matches = 0;
+    QBENCHMARK {
+        for (const QString &query : std::as_const(m_queries)) {
+            StringSimilarityMatcher matcher(query);
+            for (const QString &string : strings) {
+                if (matcher.getSimilarityScore(string) >= textSimilarityThreshold)
+                    ++matches;
+            }
+        }
+    }
+    QVERIFY(matches > 0);
+}
+
+void tst_bench_simtexth::index_data()
+{
+    addCountRows();
+}
+
+// Scores the candidates of a prebuilt StringSimilarityIndex.
+void tst_bench_simtexth::index()
+{
+    QFETCH(int, count);
+    StringSimilarityIndex index;
+    for (const QString &string : candidates(count))
+        index.append(string);
+    int matches = 0;
+    QBENCHMARK {
+        for (const QString &query : std::as_const(m_queries))
+            matches += index.bestMatches(query, 10).size();
+    }
+    QVERIFY(matches > 0);
+}
+
+void tst_bench_simtexth::buildIndex_data()
+{
+    addCountRows();
+}
+
+void tst_bench_simtexth::buildIndex()
+{
+    QFETCH(int, count);
+    const QStringList strings = candidates(count);
+    QBENCHMARK {
+        StringSimilarityIndex index;
+        index.reserve(strings.size());
+        for (const QString &string : strings)
+            index.append(string);
+        QCOMPARE(index.size(), strings.size());
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_bench_simtexth)
+
+#include "tst_bench_simtexth.moc"
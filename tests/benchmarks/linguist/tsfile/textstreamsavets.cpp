@@ -0,0 +1,255 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+// saveTS() as it was before it wrote through a UTF-8 buffer of its own, kept
+// as the baseline of the save benchmark.
+
+#include "translator.h"
+
+#include <QtCore/QRegularExpression>
+#include <QtCore/QTextStream>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+static QString tsNumericEntity(int ch)
+{
+    return QString(ch <= 0x20 ? QLatin1String("<byte value=\"x%1\"/>")
+        : QLatin1String("&#x%1;")) .arg(ch, 0, 16);
+}
+
+static QString tsProtect(const QString &str)
+{
+    QString result;
+    result.reserve(str.size() * 12 / 10);
+    for (int i = 0; i != str.size(); ++i) {
+        const QChar ch = str[i];
+        uint c = ch.unicode();
+        switch (c) {
+        case '\"':
+            result += QLatin1String("&quot;");
+            break;
+        case '&':
+            result += QLatin1String("&amp;");
+            break;
+        case '>':
+            result += QLatin1String("&gt;");
+            break;
+        case '<':
+            result += QLatin1String("&lt;");
+            break;
+        case '\'':
+            result += QLatin1String("&apos;");
+            break;
+        default:
+            if ((c < 0x20 || (ch > QChar(0x7f) && ch.isSpace())) && c != '\n' && c != '\t')
+                result += tsNumericEntity(c);
+            else // this also covers surrogates
+                result += QChar(c);
+        }
+    }
+    return result;
+}
+
+static void writeExtras(QTextStream &t, const char *indent,
+                        const TranslatorMessage::ExtraData &extras, QRegularExpression drops)
+{
+    QStringList outs;
+    for (auto it = extras.cbegin(), end = extras.cend(); it != end; ++it) {
+        if (!drops.match(it.key()).hasMatch()) {
+            outs << (QStringLiteral("<extra-") + it.key() + QLatin1Char('>')
+                     + tsProtect(it.value())
+                     + QStringLiteral("</extra-") + it.key() + QLatin1Char('>'));
+        }
+    }
+    outs.sort();
+    for (const QString &out : std::as_const(outs))
+        t << indent << out << Qt::endl;
+}
+
+static void writeVariants(QTextStream &t, const char *indent, const QString &input)
+{
+    int offset;
+    if ((offset = input.indexOf(Translator::BinaryVariantSeparator)) >= 0) {
+        t << " variants=\"yes\">";
+        int start = 0;
+        forever {
+            t << "\n    " << indent << "<lengthvariant>"
+              << tsProtect(input.mid(start, offset - start))
+              << "</lengthvariant>";
+            if (offset == input.size())
+                break;
+            start = offset + 1;
+            offset = input.indexOf(Translator::BinaryVariantSeparator, start);
+            if (offset < 0)
+                offset = input.size();
+        }
+        t << "\n" << indent;
+    } else {
+        t << ">" << tsProtect(input);
+    }
+}
+
+bool saveTSWithTextStream(const Translator &translator, QIODevice &dev, ConversionData &cd)
+{
+    bool result = true;
+    QTextStream t(&dev);
+
+    // The xml prolog allows processors to easily detect the correct encoding
+    t << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<!DOCTYPE TS>\n";
+
+    t << "<TS version=\"2.1\"";
+
+    QString languageCode = translator.languageCode();
+    if (!languageCode.isEmpty() && languageCode != QLatin1String("C"))
+        t << " language=\"" << languageCode << "\"";
+    languageCode = translator.sourceLanguageCode();
+    if (!languageCode.isEmpty() && languageCode != QLatin1String("C"))
+        t << " sourcelanguage=\"" << languageCode << "\"";
+    t << ">\n";
+
+    const QStringList deps = translator.dependencies();
+    if (!deps.isEmpty()) {
+        t << "<dependencies>\n";
+        for (const QString &dep : deps)
+            t << "<dependency catalog=\"" << dep << "\"/>\n";
+        t << "</dependencies>\n";
+    }
+
+    QRegularExpression drops(QRegularExpression::anchoredPattern(cd.dropTags().join(QLatin1Char('|'))));
+
+    writeExtras(t, "    ", translator.extras(), drops);
+
+    // The messages are grouped by pointer, so that saving does not copy them
+    QHash<QString, QList<const TranslatorMessage *> > messageOrder;
+    QList<QString> contextOrder;
+    for (const TranslatorMessage &msg : translator.messages()) {
+        // no need for such noise
+        if ((msg.type() == TranslatorMessage::Obsolete || msg.type() == TranslatorMessage::Vanished)
+            && msg.translation().isEmpty()) {
+            continue;
+        }
+
+        QList<const TranslatorMessage *> &context = messageOrder[msg.context()];
+        if (context.isEmpty())
+            contextOrder.append(msg.context());
+        context.append(&msg);
+    }
+    if (cd.sortContexts())
+        std::sort(contextOrder.begin(), contextOrder.end());
+
+    QHash<QString, int> currentLine;
+    QString currentFile;
+    for (const QString &context : std::as_const(contextOrder)) {
+        t << "<context>\n"
+             "    <name>"
+          << tsProtect(context)
+          << "</name>\n";
+        for (const TranslatorMessage *message : std::as_const(messageOrder[context])) {
+            const TranslatorMessage &msg = *message;
+            //msg.dump();
+
+                t << "    <message";
+                if (!msg.id().isEmpty())
+                    t << " id=\"" << tsProtect(msg.id()) << "\"";
+                if (msg.isPlural())
+                    t << " numerus=\"yes\"";
+                t << ">\n";
+                if (translator.locationsType() != Translator::NoLocations) {
+                    QString cfile = currentFile;
+                    bool first = true;
+                    for (const TranslatorMessage::Reference &ref : msg.allReferences()) {
+                        QString fn = cd.m_targetDir.relativeFilePath(ref.fileName())
+                                    .replace(QLatin1Char('\\'),QLatin1Char('/'));
+                        int ln = ref.lineNumber();
+                        QString ld;
+                        if (translator.locationsType() == Translator::RelativeLocations) {
+                            if (ln != -1) {
+                                int dlt = ln - currentLine[fn];
+                                if (dlt >= 0)
+                                    ld.append(QLatin1Char('+'));
+                                ld.append(QString::number(dlt));
+                                currentLine[fn] = ln;
+                            }
+
+                            if (fn != cfile) {
+                                if (first)
+                                    currentFile = fn;
+                                cfile = fn;
+                            } else {
+                                fn.clear();
+                            }
+                            first = false;
+                        } else {
+                            if (ln != -1)
+                                ld = QString::number(ln);
+                        }
+                        t << "        <location";
+                        if (!fn.isEmpty())
+                            t << " filename=\"" << fn << "\"";
+                        if (!ld.isEmpty())
+                            t << " line=\"" << ld << "\"";
+                        t << "/>\n";
+                    }
+                }
+
+                t << "        <source>"
+                  << tsProtect(msg.sourceText())
+                  << "</source>\n";
+
+                if (!msg.oldSourceText().isEmpty())
+                    t << "        <oldsource>" << tsProtect(msg.oldSourceText()) << "</oldsource>\n";
+
+                if (!msg.comment().isEmpty()) {
+                    t << "        <comment>"
+                      << tsProtect(msg.comment())
+                      << "</comment>\n";
+                }
+
+                    if (!msg.oldComment().isEmpty())
+                        t << "        <oldcomment>" << tsProtect(msg.oldComment()) << "</oldcomment>\n";
+
+                    if (!msg.extraComment().isEmpty())
+                        t << "        <extracomment>" << tsProtect(msg.extraComment())
+                          << "</extracomment>\n";
+
+                    if (!msg.translatorComment().isEmpty())
+                        t << "        <translatorcomment>" << tsProtect(msg.translatorComment())
+                          << "</translatorcomment>\n";
+
+                t << "        <translation";
+                if (msg.type() == TranslatorMessage::Unfinished)
+                    t << " type=\"unfinished\"";
+                else if (msg.type() == TranslatorMessage::Vanished)
+                    t << " type=\"vanished\"";
+                else if (msg.type() == TranslatorMessage::Obsolete)
+                    t << " type=\"obsolete\"";
+                if (msg.isPlural()) {
+                    t << ">";
+                    const QStringList &translns = msg.translations();
+                    for (int j = 0; j < translns.size(); ++j) {
+                        t << "\n            <numerusform";
+                        writeVariants(t, "            ", translns[j]);
+                        t << "</numerusform>";
+                    }
+                    t << "\n        ";
+                } else {
+                    writeVariants(t, "        ", msg.translation());
+                }
+                t << "</translation>\n";
+
+                writeExtras(t, "        ", msg.extras(), drops);
+
+                if (!msg.userData().isEmpty())
+                    t << "        <userdata>" << msg.userData() << "</userdata>\n";
+                t << "    </message>\n";
+        }
+        t << "</context>\n";
+    }
+
+    t << "</TS>\n";
+    return result;
+}
+
+QT_END_NAMESPACE
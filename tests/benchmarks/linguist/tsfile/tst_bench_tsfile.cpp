@@ -0,0 +1,407 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <qmview.h>
+#include <translator.h>
+
+#include <QtTest/QtTest>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QRandomGenerator>
+#include <QtCore/QTemporaryDir>
+
+#include <optional>
+
+using namespace Qt::Literals::StringLiterals;
+
+QT_BEGIN_NAMESPACE
+bool saveTSWithTextStream(const Translator &translator, QIODevice &dev, ConversionData &cd);
+QT_END_NAMESPACE
+
+class tst_bench_tsfile : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void load_data();
+    void load();
+    void loadQm_data();
+    void loadQm();
+    void viewQm_data();
+    void viewQm();
+    void save_data();
+    void save();
+    void saveTextStream_data();
+    void saveTextStream();
+    void buildIndexes_data();
+    void buildIndexes();
+    void merge_data();
+    void merge();
+    void appendSorted_data();
+    void appendSorted();
+    void createMessages_data();
+    void createMessages();
+    void stringBytes_data();
+    void stringBytes();
+
+private:
+    QString messageFile(int count, const QString &format);
+    QString tsFile(int count) { return messageFile(count, u"ts"_s); }
+    QString qmFile(int count) { return messageFile(count, u"qm"_s); }
+
+    QTemporaryDir m_dir;
+    QSet<QString> m_files;
+};
+
+void tst_bench_tsfile::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+}
+
+// Writes a file in the given format with count messages, which share a few
+// hundred contexts and source files, like the files of a big application.
+QString tst_bench_tsfile::messageFile(int count, const QString &format)
+{
+    const QString fileName = m_dir.filePath(u"messages_%1.%2"_s.arg(count).arg(format));
+    if (m_files.contains(fileName))
+        return fileName;
+
+    QRandomGenerator random(42);
+    Translator tor;
+    tor.setLanguageCode(u"de_DE"_s);
+    for (int i = 0; i < count; ++i) {
+        const QString context = u"Context%1"_s.arg(random.bounded(200));
+        TranslatorMessage msg(context, u"Source text %1"_s.arg(i), QString(), QString(),
+                              u"src/module%1/file%2.cpp"_s.arg(random.bounded(20))
+                                      .arg(random.bounded(15)),
+                              random.bounded(1, 2000), { u"Übersetzung %1"_s.arg(i) },
+                              TranslatorMessage::Finished);
+        for (int j = random.bounded(3); j > 0; --j) {
+            msg.addReference(u"src/module%1/file%2.cpp"_s.arg(random.bounded(20))
+                                     .arg(random.bounded(15)),
+                             random.bounded(1, 2000));
+        }
+        tor.append(msg);
+    }
+
+    ConversionData cd;
+    if (!tor.save(fileName, cd, format))
+        return QString();
+    m_files.insert(fileName);
+    return fileName;
+}
+
+static void addCountRows()
+{
+    QTest::addColumn<int>("count");
+    for (int count : { 10000, 100000 })
+        QTest::addRow("%d", count) << count;
+}
+
+void tst_bench_tsfile::load_data()
+{
+    addCountRows();
+}
+
+void tst_bench_tsfile::load()
+{
+    QFETCH(int, count);
+    const QString fileName = tsFile(count);
+    QVERIFY(!fileName.isEmpty());
+
+    QBENCHMARK {
+        Translator tor;
+        ConversionData cd;
+        QVERIFY(tor.load(fileName, cd, u"ts"_s));
+        QCOMPARE(tor.messageCount(), count);
+    }
+}
+
+void tst_bench_tsfile::loadQm_data()
+{
+    addCountRows();
+}
+
+void tst_bench_tsfile::loadQm()
+{
+    QFETCH(int, count);
+    const QString fileName = qmFile(count);
+    QVERIFY(!fileName.isEmpty());
+
+    QBENCHMARK {
+        Translator tor;
+        ConversionData cd;
+        QVERIFY(tor.load(fileName, cd, u"qm"_s));
+        QCOMPARE(tor.messageCount(), count);
+    }
+}
+
+void tst_bench_tsfile::viewQm_data()
+{
+    addCountRows();
+}
+
+// Walks all messages of a QM file in place, as a tool that only needs to
+// look at a few of them would.
+void tst_bench_tsfile::viewQm()
+{
+    QFETCH(int, count);
+    const QString fileName = qmFile(count);
+    QVERIFY(!fileName.isEmpty());
+
+    QBENCHMARK {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QmView view;
+        ConversionData cd;
+        QVERIFY(view.open(file, cd));
+        QCOMPARE(view.messageCount(), count);
+        QmView::Message msg;
+        qsizetype translated = 0;
+        for (int i = 0; i < count; ++i) {
+            QVERIFY(view.readMessage(i, &msg));
+            translated += msg.translations.size();
+        }
+        QCOMPARE(translated, qsizetype(count));
+    }
+}
+
+void tst_bench_tsfile::save_data()
+{
+    addCountRows();
+}
+
+// Saves the file repeatedly for a while and reports the bytes written per
+// second, as the result depends on the size of the output.
+template <typename Save>
+static void benchmarkSave(const QString &fileName, Save save, double *bytesPerSecond)
+{
+    QElapsedTimer timer;
+    qint64 bytes = 0;
+    timer.start();
+    do {
+        QVERIFY(save(fileName));
+        bytes += QFileInfo(fileName).size();
+    } while (timer.elapsed() < 500);
+    *bytesPerSecond = bytes * 1000.0 / timer.elapsed();
+}
+
+void tst_bench_tsfile::save()
+{
+    QFETCH(int, count);
+    const QString fileName = tsFile(count);
+    QVERIFY(!fileName.isEmpty());
+    Translator tor;
+    ConversionData cd;
+    QVERIFY(tor.load(fileName, cd, u"ts"_s));
+
+    double bytesPerSecond = 0;
+    benchmarkSave(m_dir.filePath(u"saved_%1.ts"_s.arg(count)), [&](const QString &savedFileName) {
+        return tor.save(savedFileName, cd, u"ts"_s);
+    }, &bytesPerSecond);
+    if (QTest::currentTestFailed())
+        return;
+    QTest::setBenchmarkResult(bytesPerSecond, QTest::BytesPerSecond);
+}
+
+void tst_bench_tsfile::saveTextStream_data()
+{
+    addCountRows();
+}
+
+// The baseline for save(): saveTS() as it was when it wrote through a QTextStream.
+void tst_bench_tsfile::saveTextStream()
+{
+    QFETCH(int, count);
+    const QString fileName = tsFile(count);
+    QVERIFY(!fileName.isEmpty());
+    Translator tor;
+    ConversionData cd;
+    QVERIFY(tor.load(fileName, cd, u"ts"_s));
+
+    double bytesPerSecond = 0;
+    benchmarkSave(m_dir.filePath(u"saved_stream_%1.ts"_s.arg(count)),
+                  [&](const QString &savedFileName) {
+        QFile file(savedFileName);
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+        cd.m_targetDir = QFileInfo(savedFileName).absoluteDir();
+        return saveTSWithTextStream(tor, file, cd);
+    }, &bytesPerSecond);
+    if (QTest::currentTestFailed())
+        return;
+    QTest::setBenchmarkResult(bytesPerSecond, QTest::BytesPerSecond);
+}
+
+void tst_bench_tsfile::buildIndexes_data()
+{
+    addCountRows();
+}
+
+// Builds the indexes used by Translator::find(), as lupdate does for every TS
+// file it updates.
+void tst_bench_tsfile::buildIndexes()
+{
+    QFETCH(int, count);
+    const QString fileName = tsFile(count);
+    QVERIFY(!fileName.isEmpty());
+    Translator tor;
+    ConversionData cd;
+    QVERIFY(tor.load(fileName, cd, u"ts"_s));
+
+    QBENCHMARK {
+        Translator copy = tor;
+        copy.buildIndexes();
+    }
+}
+
+void tst_bench_tsfile::merge_data()
+{
+    addCountRows();
+}
+
+// Merges all messages into a file that has every second one of them, as
+// lconvert does with several input files.
+void tst_bench_tsfile::merge()
+{
+    QFETCH(int, count);
+    const QString fileName = tsFile(count);
+    QVERIFY(!fileName.isEmpty());
+    Translator tor;
+    ConversionData cd;
+    QVERIFY(tor.load(fileName, cd, u"ts"_s));
+    Translator half;
+    for (int i = 0; i < tor.messageCount(); i += 2)
+        half.append(tor.message(i));
+
+    QBENCHMARK {
+        Translator merged = half;
+        merged.replaceSorted(tor.messages());
+        QCOMPARE(merged.messageCount(), count);
+    }
+}
+
+void tst_bench_tsfile::appendSorted_data()
+{
+    QTest::addColumn<int>("count");
+    for (int count : { 1000, 10000 })
+        QTest::addRow("%d", count) << count;
+}
+
+// Inserts every tenth message into a file that lacks them, one at a time, as
+// lupdate does with new messages. Most of them go into the middle of the file.
+void tst_bench_tsfile::appendSorted()
+{
+    QFETCH(int, count);
+    const QString fileName = tsFile(count);
+    QVERIFY(!fileName.isEmpty());
+    Translator tor;
+    ConversionData cd;
+    QVERIFY(tor.load(fileName, cd, u"ts"_s));
+    Translator base;
+    QList<TranslatorMessage> added;
+    for (int i = 0; i < tor.messageCount(); ++i) {
+        if (i % 10)
+            base.append(tor.message(i));
+        else
+            added.append(tor.message(i));
+    }
+
+    QBENCHMARK {
+        Translator merged = base;
+        for (const TranslatorMessage &msg : std::as_const(added)) {
+            if (merged.find(msg) < 0)
+                merged.appendSorted(msg);
+        }
+        QCOMPARE(merged.messageCount(), count);
+    }
+}
+
+// Creates count messages from strings that are not shared yet, as the readers
+// do for every message they parse.
+static QList<TranslatorMessage> createMessages(int count)
+{
+    QRandomGenerator random(42);
+    QList<TranslatorMessage> messages;
+    messages.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        TranslatorMessage msg(u"Context%1"_s.arg(random.bounded(200)),
+                              u"Source text %1"_s.arg(i), QString(), QString(),
+                              u"src/module%1/file%2.cpp"_s.arg(random.bounded(20))
+                                      .arg(random.bounded(15)),
+                              random.bounded(1, 2000));
+        for (int j = random.bounded(3); j > 0; --j) {
+            msg.addReference(u"src/module%1/file%2.cpp"_s.arg(random.bounded(20))
+                                     .arg(random.bounded(15)),
+                             random.bounded(1, 2000));
+        }
+        messages.append(msg);
+    }
+    return messages;
+}
+
+static void addInternedRows()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("interned");
+    for (int count : { 10000, 100000 }) {
+        QTest::addRow("%d", count) << count << false;
+        QTest::addRow("%d-interned", count) << count << true;
+    }
+}
+
+void tst_bench_tsfile::createMessages_data()
+{
+    addInternedRows();
+}
+
+// Measures what interning the contexts and file names costs.
+void tst_bench_tsfile::createMessages()
+{
+    QFETCH(int, count);
+    QFETCH(bool, interned);
+
+    QBENCHMARK {
+        std::optional<TranslatorMessage::InternScope> internScope;
+        if (interned)
+            internScope.emplace();
+        QCOMPARE(createMessages(count).size(), count);
+    }
+}
+
+void tst_bench_tsfile::stringBytes_data()
+{
+    addInternedRows();
+}
+
+// Reports the bytes held by the contexts and file names of the messages,
+// without the headers of the string data, to show what interning saves.
+void tst_bench_tsfile::stringBytes()
+{
+    QFETCH(int, count);
+    QFETCH(bool, interned);
+
+    std::optional<TranslatorMessage::InternScope> internScope;
+    if (interned)
+        internScope.emplace();
+    const QList<TranslatorMessage> messages = createMessages(count);
+    internScope.reset();
+
+    QSet<const QChar *> seen;
+    qint64 bytes = 0;
+    auto account = [&](const QString &str) {
+        if (!seen.contains(str.constData())) {
+            seen.insert(str.constData());
+            bytes += (str.capacity() + 1) * sizeof(QChar);
+        }
+    };
+    for (const TranslatorMessage &msg : messages) {
+        account(msg.context());
+        for (const TranslatorMessage::Reference &ref : msg.allReferences())
+            account(ref.fileName());
+    }
+    QTest::setBenchmarkResult(bytes, QTest::BytesAllocated);
+}
+
+QTEST_MAIN(tst_bench_tsfile)
+#include "tst_bench_tsfile.moc"